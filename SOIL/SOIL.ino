@@ -14,6 +14,17 @@
 #include <DHT.h>
 #include <ArduinoJson.h>
 #include <DNSServer.h>
+#include "filters.h"
+#include "json_writer.h"
+#include "moisture_lut.h"
+#define LOOP_METRICS 1  // Per-stage loop() timing at /api/metrics, 0 compiles it out
+#define HEAP_METRICS 1  // Heap and fragmentation tracking at /api/metrics
+#define HEAP_SOAK 0     // Soak test: 10x update rate, heap line every second (tools/heap_soak.py)
+#include "heap_metrics.h"
+#define LOG_LEVEL 3     // Serial log compiled in: 1 error, 2 warn, 3 info, 4 debug
+#include "logger.h"
+#include "loop_metrics.h"
+#include "scheduler.h"
 #include "webui.h"
 
 // WiFi credentials for AP mode
@@ -23,6 +34,7 @@ const char* AP_PASSWORD = "12345678";   // AP mode password
 // DNS Server for captive portal
 const byte DNS_PORT = 53;
 IPAddress apIP(192, 168, 4, 1);
+String portalUrl;  // http://<apIP>/, built once in setupAP()
 
 // Pin Definitions
 #define SOIL_MOISTURE_PIN A0    // Soil moisture sensor analog pin
@@ -35,8 +47,21 @@ IPAddress apIP(192, 168, 4, 1);
 const int WET_VALUE = 820;    // Sensor value when soil is wet
 const int DRY_VALUE = 1024;   // Sensor value when soil is dry
 
+// Probe response as (ADC counts, moisture in 0.1 %) points sorted by counts,
+// turned into a flash lookup table at compile time. Add measured points
+// between WET_VALUE and DRY_VALUE to follow a nonlinear probe.
+constexpr CalPoint MOISTURE_CURVE[] = {{WET_VALUE, 1000}, {DRY_VALUE, 0}};
+static constexpr MoistureTable MOISTURE_TABLE PROGMEM =
+    buildMoistureTable(MOISTURE_CURVE, sizeof(MOISTURE_CURVE) / sizeof(MOISTURE_CURVE[0]));
+
+// Soil ADC filtering (filters.h): each check takes MOISTURE_SAMPLES quick
+// reads through a median (drops single spikes) and an EMA, so ADC noise no
+// longer trips the moisture error check below
+const uint8_t MOISTURE_SAMPLES = 3;
+const FilterConfig MOISTURE_FILTER = {3, 1, 0, 0};  // median 3, EMA 1/2, no Kalman
+
 // Sensor error thresholds
-const int MOISTURE_ERROR_THRESHOLD = 5;    // Consider sensor error if reading varies too quickly
+const int MOISTURE_ERROR_THRESHOLD = 5;    // Consider sensor error if the filtered reading varies too quickly
 const float TEMP_MIN_VALID = 0.0;         // Minimum valid temperature
 const float TEMP_MAX_VALID = 50.0;        // Maximum valid temperature
 const float HUMIDITY_MIN_VALID = 0.0;     // Minimum valid humidity
@@ -52,43 +77,286 @@ AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
 DNSServer dnsServer;
 bool pumpState = false;
-unsigned long lastUpdate = 0;
-const long updateInterval = 2000;  // Update interval in milliseconds
+const long updateInterval = HEAP_SOAK ? 200 : 2000;  // Update interval in milliseconds
+
+// Adaptive updates: sensors are read every updateInterval while the pump runs
+// or readings move, and the interval doubles per stable reading up to
+// UPDATE_INTERVAL_MAX. A frame is only sent when a value leaves its deadband
+// around the last frame or SEND_HEARTBEAT_INTERVAL has passed; while clients
+// are connected the sensor task wakes by the heartbeat even when the
+// adaptive interval is longer.
+const unsigned long UPDATE_INTERVAL_MAX = HEAP_SOAK ? 200 : 30000;
+const int MOISTURE_STABLE_BAND = 2;            // % change that still counts as stable
+const int SEND_DEADBAND_MOISTURE = 2;          // %
+const float SEND_DEADBAND_TEMPERATURE = 0.5;   // C
+const float SEND_DEADBAND_HUMIDITY = 2.0;      // %RH
+const unsigned long SEND_HEARTBEAT_INTERVAL = HEAP_SOAK ? 0 : 15000;  // Longest gap between frames; under the page's CONNECTION_TIMEOUT
+unsigned long currentUpdateInterval = updateInterval;
+unsigned long framesSkipped = 0;
+
+// Values and flags of the last frame broadcast
+struct SentFrame {
+    float temperature;
+    float humidity;
+    int moisture;
+    uint8_t flags;
+    unsigned long time;
+    bool valid;
+};
+SentFrame lastSentFrame = {NAN, NAN, 0, 0, 0, false};
 
 // Connection status LED
-unsigned long lastLedBlink = 0;
 const long LED_BLINK_INTERVAL = 2000;  // LED blink interval when client connected
+const long LED_BLINK_LENGTH = 100;     // How long the LED goes dark per blink
 bool clientConnected = false;
 
+// loop() work, highest priority first (registration order in setup())
+enum TaskId : uint8_t {
+    TASK_PUMP_TIMEOUT,
+    TASK_DNS,
+    TASK_SENSORS,
+    TASK_WS_CLEANUP,
+    TASK_LED,
+    TASK_HEAP,
+    TASK_CONSOLE,
+    TASK_LOG
+};
+static const char TASK_NAME_PUMP_TIMEOUT[] PROGMEM = "pump_timeout";
+static const char TASK_NAME_DNS[] PROGMEM = "dns";
+static const char TASK_NAME_SENSORS[] PROGMEM = "sensors";
+static const char TASK_NAME_WS_CLEANUP[] PROGMEM = "ws_cleanup";
+static const char TASK_NAME_LED[] PROGMEM = "led";
+static const char TASK_NAME_HEAP[] PROGMEM = "heap";
+static const char TASK_NAME_CONSOLE[] PROGMEM = "console";
+static const char TASK_NAME_LOG[] PROGMEM = "log";
+Scheduler scheduler;
+const unsigned long WS_CLEANUP_INTERVAL = 1000;   // ms between closed-client sweeps
+const unsigned long CONSOLE_POLL_INTERVAL = 100;  // ms between serial console polls
+
+// Serial log, drained at the end of loop()
+enum LogModule : uint8_t {
+    MODULE_SENSOR,
+    MODULE_WS,
+    MODULE_HEAP
+};
+static const char MODULE_NAME_SENSOR[] PROGMEM = "sensor";
+static const char MODULE_NAME_WS[] PROGMEM = "ws";
+static const char MODULE_NAME_HEAP[] PROGMEM = "heap";
+static const char *const LOG_MODULE_NAMES[] = {MODULE_NAME_SENSOR, MODULE_NAME_WS, MODULE_NAME_HEAP};
+Logger logger(LOG_MODULE_NAMES);
+
+// loop() stages timed for /api/metrics
+enum LoopStage : uint8_t {
+    STAGE_DNS,
+    STAGE_WS_CLEANUP,
+    STAGE_LED,
+    STAGE_PUMP_TIMEOUT,
+    STAGE_SENSORS,
+    STAGE_SEND,
+    STAGE_COUNT
+};
+const size_t METRICS_LINE_MAX = 112;  // Longest /api/metrics line
+
+#if LOOP_METRICS
+static const char STAGE_NAME_DNS[] PROGMEM = "dns";
+static const char STAGE_NAME_WS_CLEANUP[] PROGMEM = "ws_cleanup";
+static const char STAGE_NAME_LED[] PROGMEM = "led";
+static const char STAGE_NAME_PUMP_TIMEOUT[] PROGMEM = "pump_timeout";
+static const char STAGE_NAME_SENSORS[] PROGMEM = "sensors";
+static const char STAGE_NAME_SEND[] PROGMEM = "send";
+static const char *const LOOP_STAGE_NAMES[STAGE_COUNT] = {
+    STAGE_NAME_DNS, STAGE_NAME_WS_CLEANUP, STAGE_NAME_LED,
+    STAGE_NAME_PUMP_TIMEOUT, STAGE_NAME_SENSORS, STAGE_NAME_SEND
+};
+LoopMetrics<STAGE_COUNT> loopMetrics(LOOP_STAGE_NAMES);
+#endif
+
+// Heap users tracked for /api/metrics
+enum HeapSubsystem : uint8_t {
+    HEAP_DNS,
+    HEAP_WS_SEND,
+    HEAP_WS_EVENT,
+    HEAP_PORTAL,
+    HEAP_METRICS_ENDPOINT,
+    HEAP_SUBSYSTEM_COUNT
+};
+const unsigned long HEAP_SAMPLE_INTERVAL = 1000;  // ms between heap samples
+
+#if HEAP_METRICS
+static const char HEAP_NAME_DNS[] PROGMEM = "dns";
+static const char HEAP_NAME_WS_SEND[] PROGMEM = "ws_send";
+static const char HEAP_NAME_WS_EVENT[] PROGMEM = "ws_event";
+static const char HEAP_NAME_PORTAL[] PROGMEM = "portal";
+static const char HEAP_NAME_METRICS[] PROGMEM = "metrics";
+static const char *const HEAP_SUBSYSTEM_NAMES[HEAP_SUBSYSTEM_COUNT] = {
+    HEAP_NAME_DNS, HEAP_NAME_WS_SEND, HEAP_NAME_WS_EVENT, HEAP_NAME_PORTAL, HEAP_NAME_METRICS
+};
+HeapMetrics<HEAP_SUBSYSTEM_COUNT> heapMetrics(HEAP_SUBSYSTEM_NAMES);
+#endif
+
 // Sensor state variables
+SensorFilter moistureFilter;
+MoistureLut moistureLut;
 float lastMoisture = -1;
 bool moistureError = false;
 bool temperatureError = false;
 bool humidityError = false;
 
+// Timestamped sensor readings shared by every consumer. Only sensorTask
+// reads the sensors; consumers between ticks (a new client, a pump toggle,
+// a format switch) get the last tick's values as they are, so the jump
+// check and the adaptive interval only ever see scheduled readings.
+struct SensorSnapshot {
+    float temperature;
+    float humidity;
+    int moisture;
+    unsigned long timestamp;
+    bool valid;
+};
+SensorSnapshot sensorSnapshot = {NAN, NAN, 0, 0, false};
+unsigned long sensorReads = 0;
+
+// Sensor frame schema, keys kept in flash
+static const char KEY_TEMPERATURE[] PROGMEM = "temperature";
+static const char KEY_HUMIDITY[] PROGMEM = "humidity";
+static const char KEY_MOISTURE[] PROGMEM = "moisture";
+static const char KEY_PUMP_STATE[] PROGMEM = "pumpState";
+static const char KEY_TEMPERATURE_ERROR[] PROGMEM = "temperature_error";
+static const char KEY_HUMIDITY_ERROR[] PROGMEM = "humidity_error";
+static const char KEY_MOISTURE_ERROR[] PROGMEM = "moisture_error";
+
+const size_t SENSOR_JSON_SIZE = 3 +
+    jsonFieldSize(sizeof(KEY_TEMPERATURE), JSON_FIXED_MAX_CHARS) +
+    jsonFieldSize(sizeof(KEY_HUMIDITY), JSON_FIXED_MAX_CHARS) +
+    jsonFieldSize(sizeof(KEY_MOISTURE), JSON_INT_MAX_CHARS) +
+    jsonFieldSize(sizeof(KEY_PUMP_STATE), JSON_INT_MAX_CHARS) +
+    jsonFieldSize(sizeof(KEY_TEMPERATURE_ERROR), JSON_BOOL_MAX_CHARS) +
+    jsonFieldSize(sizeof(KEY_HUMIDITY_ERROR), JSON_BOOL_MAX_CHARS) +
+    jsonFieldSize(sizeof(KEY_MOISTURE_ERROR), JSON_BOOL_MAX_CHARS);
+
+// Binary sensor frame, sent instead of JSON to clients that ask for it with
+// {"command":"binary","state":1}. Little-endian, decoded by webui.h:
+//   0 u8  version (SENSOR_FRAME_VERSION)
+//   1 u8  flags (SENSOR_FLAG_*)
+//   2 u16 sequence number
+//   4 i16 temperature in 0.1 C
+//   6 u16 humidity in 0.1 %
+//   8 u8  moisture in %
+const uint8_t SENSOR_FRAME_VERSION = 1;
+const uint8_t SENSOR_FLAG_PUMP = 0x01;
+const uint8_t SENSOR_FLAG_TEMPERATURE_ERROR = 0x02;
+const uint8_t SENSOR_FLAG_HUMIDITY_ERROR = 0x04;
+const uint8_t SENSOR_FLAG_MOISTURE_ERROR = 0x08;
+
+struct __attribute__((packed)) SensorFrame {
+    uint8_t version;
+    uint8_t flags;
+    uint16_t sequence;
+    int16_t temperature;
+    uint16_t humidity;
+    uint8_t moisture;
+};
+static_assert(sizeof(SensorFrame) == 9, "SensorFrame layout changed");
+uint16_t sensorFrameSequence = 0;
+
+// Connected WebSocket clients and the frame format each one negotiated
+struct WsClientMode {
+    uint32_t id;
+    bool binary;
+};
+const uint8_t WS_MAX_CLIENTS = 8;
+WsClientMode wsClients[WS_MAX_CLIENTS];
+uint8_t wsClientCount = 0;
+uint8_t wsBinaryCount = 0;
+
+// OS connectivity probes, answered with a few-byte canned reply instead of
+// the dashboard. Phones and laptops send a burst of these on association.
+enum ProbeReply : uint8_t {
+    PROBE_REDIRECT,  // 302 to the portal, raises the OS sign-in prompt
+    PROBE_EMPTY      // 204, nothing worth sending
+};
+
+struct CaptiveProbe {
+    const char *path;  // PROGMEM
+    ProbeReply reply;
+};
+
+static const char PROBE_GENERATE_204[] PROGMEM = "/generate_204";        // Android
+static const char PROBE_GEN_204[] PROGMEM = "/gen_204";                  // Android, Chrome
+static const char PROBE_HOTSPOT_DETECT[] PROGMEM = "/hotspot-detect.html";  // iOS, macOS
+static const char PROBE_APPLE_SUCCESS[] PROGMEM = "/library/test/success.html";  // iOS
+static const char PROBE_CONNECTTEST[] PROGMEM = "/connecttest.txt";      // Windows 10+
+static const char PROBE_NCSI[] PROGMEM = "/ncsi.txt";                    // Windows
+static const char PROBE_MS_REDIRECT[] PROGMEM = "/redirect";             // Windows
+static const char PROBE_CANONICAL[] PROGMEM = "/canonical.html";         // Firefox
+static const char PROBE_SUCCESS_TXT[] PROGMEM = "/success.txt";          // Firefox
+static const char PROBE_FAVICON[] PROGMEM = "/favicon.ico";
+
+static const CaptiveProbe CAPTIVE_PROBES[] = {
+    {PROBE_GENERATE_204, PROBE_REDIRECT},
+    {PROBE_GEN_204, PROBE_REDIRECT},
+    {PROBE_HOTSPOT_DETECT, PROBE_REDIRECT},
+    {PROBE_APPLE_SUCCESS, PROBE_REDIRECT},
+    {PROBE_CONNECTTEST, PROBE_REDIRECT},
+    {PROBE_NCSI, PROBE_REDIRECT},
+    {PROBE_MS_REDIRECT, PROBE_REDIRECT},
+    {PROBE_CANONICAL, PROBE_REDIRECT},
+    {PROBE_SUCCESS_TXT, PROBE_REDIRECT},
+    {PROBE_FAVICON, PROBE_EMPTY},
+};
+
+const CaptiveProbe *findCaptiveProbe(const String &url) {
+    for (const CaptiveProbe &probe : CAPTIVE_PROBES) {
+        if (strcmp_P(url.c_str(), probe.path) == 0) {
+            return &probe;
+        }
+    }
+    return nullptr;
+}
+
+// Serves the pre-gzipped dashboard straight from flash, or 304 if the
+// browser already has this build of it
+void sendIndexHtml(AsyncWebServerRequest *request) {
+    AsyncWebServerResponse *response;
+    if (request->hasHeader("If-None-Match") &&
+        request->getHeader("If-None-Match")->value() == INDEX_HTML_ETAG) {
+        response = request->beginResponse(304);
+    } else {
+        response = request->beginResponse_P(200, "text/html", INDEX_HTML_GZ, INDEX_HTML_GZ_LEN);
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    response->addHeader("ETag", INDEX_HTML_ETAG);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
 class CaptiveRequestHandler : public AsyncWebHandler {
 public:
     CaptiveRequestHandler() {}
     virtual ~CaptiveRequestHandler() {}
 
     bool canHandle(AsyncWebServerRequest *request) {
-        // Handle all requests
+        // Handle all requests, keeping If-None-Match for ETag validation
+        request->addInterestingHeader("If-None-Match");
         return true;
     }
 
     void handleRequest(AsyncWebServerRequest *request) {
-        // Android requires this header for captive portal detection
-        AsyncWebServerResponse *response = request->beginResponse_P(200, "text/html", index_html);
-        response->addHeader("Cache-Control", "no-cache, no-store, must-revalidate");
-        response->addHeader("Pragma", "no-cache");
-        response->addHeader("Expires", "-1");
-        
-        // Add Android captive portal detection response
-        if (request->host() != apIP.toString()) {
-            response->addHeader("Location", String("http://") + apIP.toString());
+        HEAP_SCOPE(heapMetrics, HEAP_PORTAL);
+        const CaptiveProbe *probe = findCaptiveProbe(request->url());
+        if (probe && probe->reply == PROBE_EMPTY) {
+            request->send(204);
+            return;
         }
         
-        request->send(response);
+        // Only a real page load on our own address gets the dashboard;
+        // probes and other hosts are bounced to it with a bodyless 302
+        bool navigation = request->url() == "/" || request->url() == "/index.html";
+        if (!probe && navigation && request->host() == apIP.toString()) {
+            sendIndexHtml(request);
+        } else {
+            request->redirect(portalUrl);
+        }
     }
 };
 
@@ -105,6 +373,8 @@ void setup() {
 
     // Initialize DHT sensor
     dht.begin();
+    moistureFilter.configure(MOISTURE_FILTER);
+    moistureLut.useTable(&MOISTURE_TABLE);
     delay(2000);  // Give time for DHT sensor to stabilize
 
     // Setup AP mode with captive portal
@@ -114,6 +384,9 @@ void setup() {
     ws.onEvent(onEvent);
     server.addHandler(&ws);
 
+    // Metrics, ahead of the captive portal handler that takes everything else
+    server.on("/api/metrics", HTTP_GET, handleMetrics);
+
     // Add captive portal handler
     server.addHandler(new CaptiveRequestHandler()).setFilter(ON_AP_FILTER);
 
@@ -121,12 +394,36 @@ void setup() {
     server.begin();
     Serial.println("HTTP server started");
     digitalWrite(LED_PIN, LOW);  // Turn LED on when everything is ready
+
+#if LOOP_METRICS
+    loopMetrics.calibrate();
+#endif
+#if HEAP_METRICS
+    heapMetrics.sample();
+#endif
+
+    // Registration order is priority order and must match TaskId
+    scheduler.add(TASK_NAME_PUMP_TIMEOUT, pumpTimeoutTask, 500, true);
+    scheduler.add(TASK_NAME_DNS, dnsTask, 2000);
+    scheduler.add(TASK_NAME_SENSORS, sensorTask, 40000);
+    scheduler.add(TASK_NAME_WS_CLEANUP, wsCleanupTask, 1000);
+    scheduler.add(TASK_NAME_LED, ledTask, 200);
+    scheduler.add(TASK_NAME_HEAP, heapTask, 2000);
+    scheduler.add(TASK_NAME_CONSOLE, consoleTask, 20000);
+    scheduler.add(TASK_NAME_LOG, logTask, 1000);
+
+    unsigned long now = millis();
+    scheduler.begin(now);
+    for (uint8_t id = TASK_DNS; id < scheduler.count(); id++) {
+        scheduler.wake(id, now);
+    }
 }
 
 void setupAP() {
     WiFi.mode(WIFI_AP);
     WiFi.softAPConfig(apIP, apIP, IPAddress(255, 255, 255, 0));
     WiFi.softAP(AP_SSID, AP_PASSWORD);
+    portalUrl = String("http://") + apIP.toString() + "/";
 
     // Configure DNS server to redirect all domains to our IP
     dnsServer.setErrorReplyCode(DNSReplyCode::NoError);
@@ -140,33 +437,225 @@ void setupAP() {
 }
 
 void loop() {
+    scheduler.run(millis());
+}
+
+// Safety stop, armed when a WebSocket command starts the pump
+uint32_t pumpTimeoutTask(uint32_t now) {
+    if (!pumpState) {
+        return SCHED_NEVER;
+    }
+    if (now - pumpStartTime < PUMP_TIMEOUT) {
+        return pumpStartTime + PUMP_TIMEOUT - now;
+    }
+    LOOP_PROBE(loopMetrics, STAGE_PUMP_TIMEOUT);
+    pumpState = false;
+    digitalWrite(RELAY_PIN, LOW);
+    sendSensorData();  // Update clients about pump state change
+    return SCHED_NEVER;
+}
+
+uint32_t dnsTask(uint32_t now) {
+    LOOP_PROBE(loopMetrics, STAGE_DNS);
+    HEAP_SCOPE(heapMetrics, HEAP_DNS);
     dnsServer.processNextRequest();
+    return 0;
+}
+
+// Reads the sensors at the adaptive rate and sends a frame when one is due,
+// waking early for the heartbeat while a client is connected
+uint32_t sensorTask(uint32_t now) {
+    float previousMoisture = lastMoisture;
+    {
+        LOOP_PROBE(loopMetrics, STAGE_SENSORS);
+        checkSensors();
+    }
+    adaptUpdateInterval(previousMoisture);
+    if (sensorFrameDue(now)) {
+        LOOP_PROBE(loopMetrics, STAGE_SEND);
+        HEAP_SCOPE(heapMetrics, HEAP_WS_SEND);
+        sendSensorData();
+    } else {
+        framesSkipped++;
+    }
+    unsigned long wait = currentUpdateInterval;
+    if (wsClientCount > 0 && lastSentFrame.valid && SEND_HEARTBEAT_INTERVAL > 0) {
+        unsigned long heartbeat = lastSentFrame.time + SEND_HEARTBEAT_INTERVAL - now;
+        if ((long)heartbeat > 0 && heartbeat < wait) {
+            wait = heartbeat;
+        }
+    }
+    return wait;
+}
+
+// Back to updateInterval while the pump runs or readings move; otherwise
+// each stable reading doubles the interval up to UPDATE_INTERVAL_MAX
+void adaptUpdateInterval(float previousMoisture) {
+    bool moving = previousMoisture < 0 || fabsf(lastMoisture - previousMoisture) > MOISTURE_STABLE_BAND;
+    if (pumpState || moving || temperatureError || humidityError || moistureError) {
+        currentUpdateInterval = updateInterval;
+    } else if (currentUpdateInterval < UPDATE_INTERVAL_MAX) {
+        currentUpdateInterval = min(currentUpdateInterval * 2, UPDATE_INTERVAL_MAX);
+    }
+}
+
+// True when a value left its deadband since the last frame, a flag changed,
+// or the heartbeat is due
+bool sensorFrameDue(unsigned long now) {
+    const SensorSnapshot &snapshot = sensorSnapshot;
+    if (!lastSentFrame.valid || now - lastSentFrame.time >= SEND_HEARTBEAT_INTERVAL ||
+        sensorFlags() != lastSentFrame.flags) {
+        return true;
+    }
+    return abs(snapshot.moisture - lastSentFrame.moisture) >= SEND_DEADBAND_MOISTURE ||
+           fabsf(snapshot.temperature - lastSentFrame.temperature) >= SEND_DEADBAND_TEMPERATURE ||
+           fabsf(snapshot.humidity - lastSentFrame.humidity) >= SEND_DEADBAND_HUMIDITY;
+}
+
+uint8_t sensorFlags() {
+    return (pumpState ? SENSOR_FLAG_PUMP : 0) |
+           (temperatureError ? SENSOR_FLAG_TEMPERATURE_ERROR : 0) |
+           (humidityError ? SENSOR_FLAG_HUMIDITY_ERROR : 0) |
+           (moistureError ? SENSOR_FLAG_MOISTURE_ERROR : 0);
+}
+
+uint32_t wsCleanupTask(uint32_t now) {
+    LOOP_PROBE(loopMetrics, STAGE_WS_CLEANUP);
     ws.cleanupClients();
-    
-    // Handle LED status indicator
-    if (clientConnected && (millis() - lastLedBlink >= LED_BLINK_INTERVAL)) {
-        digitalWrite(LED_PIN, HIGH);  // LED off
-        delay(100);
+    return WS_CLEANUP_INTERVAL;
+}
+
+// Status LED: a short dark blink every LED_BLINK_INTERVAL while a client is
+// connected, in two steps instead of a blocking delay
+uint32_t ledTask(uint32_t now) {
+    static bool ledDark = false;
+    LOOP_PROBE(loopMetrics, STAGE_LED);
+    if (ledDark) {
         digitalWrite(LED_PIN, LOW);   // LED on
-        lastLedBlink = millis();
+        ledDark = false;
+        return LED_BLINK_INTERVAL - LED_BLINK_LENGTH;
     }
-    
-    // Check pump timeout
-    if (pumpState && (millis() - pumpStartTime >= PUMP_TIMEOUT)) {
-        pumpState = false;
-        digitalWrite(RELAY_PIN, LOW);
-        sendSensorData();  // Update clients about pump state change
+    if (clientConnected) {
+        digitalWrite(LED_PIN, HIGH);  // LED off
+        ledDark = true;
+        return LED_BLINK_LENGTH;
     }
+    return LED_BLINK_INTERVAL;
+}
 
-    // Send sensor data every updateInterval
-    if ((millis() - lastUpdate) > updateInterval) {
-        checkSensors();
-        sendSensorData();
-        lastUpdate = millis();
+uint32_t heapTask(uint32_t now) {
+#if HEAP_METRICS
+    heapMetrics.sample();
+#if HEAP_SOAK
+    printHeapMetrics();
+#endif
+    return HEAP_SAMPLE_INTERVAL;
+#else
+    return SCHED_NEVER;
+#endif
+}
+
+// 'm' on the serial console prints the stage timings, heap and task state
+uint32_t consoleTask(uint32_t now) {
+    if (Serial.available() > 0 && Serial.read() == 'm') {
+        printMetrics();
+    }
+    return CONSOLE_POLL_INTERVAL;
+}
+
+// Hand buffered log text to the UART
+uint32_t logTask(uint32_t now) {
+    logger.drain(Serial);
+    return 0;
+}
+
+// GET /api/metrics
+// Prometheus text exposition, streamed a line at a time so the size of the
+// response does not depend on free heap
+void handleMetrics(AsyncWebServerRequest *request) {
+    HEAP_SCOPE(heapMetrics, HEAP_METRICS_ENDPOINT);
+    AsyncWebServerResponse *response = request->beginChunkedResponse("text/plain; version=0.0.4",
+        [line = 0](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+            char *out = (char *)buffer;
+            size_t len = 0;
+            if (maxLen < METRICS_LINE_MAX) {
+                return RESPONSE_TRY_AGAIN;
+            }
+            while (maxLen - len >= METRICS_LINE_MAX) {
+                size_t written = formatMetricsLine(line, out + len, maxLen - len);
+                if (written == 0) {
+                    break;
+                }
+                len += written;
+                line++;
+            }
+            return len;
+        });
+    request->send(response);
+}
+
+// Line n of the /api/metrics body; 0 past the end
+size_t formatMetricsLine(uint16_t n, char *out, size_t size) {
+#if LOOP_METRICS
+    if (n < loopMetrics.lineCount()) {
+        return loopMetrics.formatLine(n, out, size);
+    }
+    n -= loopMetrics.lineCount();
+#endif
+#if HEAP_METRICS
+    if (n < heapMetrics.lineCount()) {
+        return heapMetrics.formatLine(n, out, size);
+    }
+    n -= heapMetrics.lineCount();
+#endif
+    if (n < scheduler.lineCount()) {
+        return scheduler.formatLine(n, out, size);
+    }
+    n -= scheduler.lineCount();
+    switch (n) {
+        case 0: return snprintf(out, size, "# TYPE ws_clients gauge\n");
+        case 1: return snprintf(out, size, "ws_clients %u\n", ws.count());
+    }
+    return logger.formatLine(n - 2, out, size);
+}
+
+#if HEAP_METRICS
+void printHeapMetrics() {
+    LOG_INFO(logger, MODULE_HEAP, "Heap: free=%lu min=%lu max_block=%lu min_block=%lu frag=%u%% max_frag=%u%%",
+             (unsigned long)heapMetrics.free(), (unsigned long)heapMetrics.minFree(),
+             (unsigned long)heapMetrics.maxBlock(), (unsigned long)heapMetrics.minMaxBlock(),
+             heapMetrics.fragmentation(), heapMetrics.maxFragmentation());
+}
+#endif
+
+void printMetrics() {
+    char line[METRICS_LINE_MAX];
+#if LOOP_METRICS
+    for (uint8_t stage = 0; stage < STAGE_COUNT; stage++) {
+        loopMetrics.formatSummary(stage, line, sizeof(line));
+        Serial.print(line);
+    }
+    Serial.printf("Probe overhead: %lu cycles\n", (unsigned long)loopMetrics.probeCycles());
+#endif
+#if HEAP_METRICS
+    printHeapMetrics();
+#endif
+    for (uint8_t id = 0; id < scheduler.count(); id++) {
+        scheduler.formatSummary(id, line, sizeof(line));
+        Serial.print(line);
     }
 }
 
+// The readings of the last sensor tick; not valid before the first one
+const SensorSnapshot &getSensorSnapshot() {
+    return sensorSnapshot;
+}
+
+// Reads every sensor once into the snapshot and validates the readings.
+// Called from sensorTask only.
 void checkSensors() {
+    sensorReads++;
+    
     // Check DHT sensor
     float humidity = dht.readHumidity();
     float temperature = dht.readTemperature();
@@ -182,16 +671,22 @@ void checkSensors() {
     }
     lastMoisture = currentMoisture;
     
+    sensorSnapshot.temperature = temperature;
+    sensorSnapshot.humidity = humidity;
+    sensorSnapshot.moisture = currentMoisture;
+    sensorSnapshot.timestamp = millis();
+    sensorSnapshot.valid = true;
+    
     // Log sensor errors
     if (temperatureError || humidityError || moistureError) {
-        Serial.println("Sensor Errors Detected:");
-        if (temperatureError) Serial.println("- Temperature sensor error");
-        if (humidityError) Serial.println("- Humidity sensor error");
-        if (moistureError) Serial.println("- Moisture sensor error");
+        LOG_WARN(logger, MODULE_SENSOR, "Sensor errors:%S%S%S",
+                 temperatureError ? PSTR(" temperature") : PSTR(""),
+                 humidityError ? PSTR(" humidity") : PSTR(""),
+                 moistureError ? PSTR(" moisture") : PSTR(""));
     }
 }
 
-void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
+void handleWebSocketMessage(AsyncWebSocketClient *client, void *arg, uint8_t *data, size_t len) {
     AwsFrameInfo *info = (AwsFrameInfo*)arg;
     if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
         data[len] = 0;
@@ -209,10 +704,18 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
                     
                     if (pumpState) {
                         pumpStartTime = millis();  // Start pump timer
+                        scheduler.wakeAt(TASK_PUMP_TIMEOUT, pumpStartTime + PUMP_TIMEOUT);
+                        currentUpdateInterval = updateInterval;  // Fast updates while watering
+                        scheduler.wake(TASK_SENSORS, pumpStartTime, updateInterval);
+                    } else {
+                        scheduler.cancel(TASK_PUMP_TIMEOUT);
                     }
                     
                     sendSensorData();  // Send immediate update
                 }
+            } else if (doc.containsKey("command") && doc["command"] == "binary") {
+                setWsClientBinary(client->id(), doc["state"] == 1);
+                sendSensorDataTo(client);
             }
         }
     }
@@ -220,18 +723,25 @@ void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
 
 void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
             void *arg, uint8_t *data, size_t len) {
+    HEAP_SCOPE(heapMetrics, HEAP_WS_EVENT);
     switch (type) {
         case WS_EVT_CONNECT:
-            Serial.printf("WebSocket client #%u connected from %s\n", client->id(), client->remoteIP().toString().c_str());
+            LOG_INFO(logger, MODULE_WS, "WebSocket client #%u connected from %s", client->id(), client->remoteIP().toString().c_str());
+            if (!addWsClient(client->id())) {
+                client->close();
+                break;
+            }
             clientConnected = true;
-            sendSensorData();  // Send data immediately on connect
+            sendSensorDataTo(client);  // Send data immediately on connect
+            scheduler.wake(TASK_SENSORS, millis());  // and re-arm the heartbeat for it
             break;
         case WS_EVT_DISCONNECT:
-            Serial.printf("WebSocket client #%u disconnected\n", client->id());
+            LOG_INFO(logger, MODULE_WS, "WebSocket client #%u disconnected", client->id());
+            removeWsClient(client->id());
             clientConnected = (ws.count() > 0);  // Check if any clients are still connected
             break;
         case WS_EVT_DATA:
-            handleWebSocketMessage(arg, data, len);
+            handleWebSocketMessage(client, arg, data, len);
             break;
         case WS_EVT_PONG:
         case WS_EVT_ERROR:
@@ -239,40 +749,139 @@ void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType
     }
 }
 
+bool addWsClient(uint32_t id) {
+    if (wsClientCount >= WS_MAX_CLIENTS) {
+        return false;
+    }
+    wsClients[wsClientCount++] = {id, false};
+    return true;
+}
+
+void removeWsClient(uint32_t id) {
+    for (uint8_t i = 0; i < wsClientCount; i++) {
+        if (wsClients[i].id == id) {
+            if (wsClients[i].binary) wsBinaryCount--;
+            wsClients[i] = wsClients[--wsClientCount];
+            return;
+        }
+    }
+}
+
+void setWsClientBinary(uint32_t id, bool binary) {
+    for (uint8_t i = 0; i < wsClientCount; i++) {
+        if (wsClients[i].id == id && wsClients[i].binary != binary) {
+            wsClients[i].binary = binary;
+            if (binary) wsBinaryCount++; else wsBinaryCount--;
+            return;
+        }
+    }
+}
+
+bool isWsClientBinary(uint32_t id) {
+    for (uint8_t i = 0; i < wsClientCount; i++) {
+        if (wsClients[i].id == id) return wsClients[i].binary;
+    }
+    return false;
+}
+
 int getMoisturePercentage() {
-    int rawValue = analogRead(SOIL_MOISTURE_PIN);
-    int moisturePercentage = map(rawValue, DRY_VALUE, WET_VALUE, 0, 100);
-    return constrain(moisturePercentage, 0, 100);
+    int rawValue = 0;
+    for (uint8_t i = 0; i < MOISTURE_SAMPLES; i++) {
+        rawValue = moistureFilter.update(analogRead(SOIL_MOISTURE_PIN));
+    }
+    return (moistureLut.convert(rawValue) + 5) / 10;  // 0.1 % to whole percent
 }
 
-void sendSensorData() {
-    StaticJsonDocument<200> doc;
-    
-    // Read sensor values
-    float humidity = dht.readHumidity();
-    float temperature = dht.readTemperature();
-    int moisture = getMoisturePercentage();
+// Writes the current readings as JSON; returns the length, 0 if it did not fit
+size_t buildSensorJson(char *output, size_t size) {
+    // Use the validated readings from this tick
+    const SensorSnapshot &snapshot = getSensorSnapshot();
     
     // Add sensor values and error states to JSON
-    doc["temperature"] = temperatureError ? 0 : round(temperature * 10.0) / 10.0;
-    doc["humidity"] = humidityError ? 0 : round(humidity * 10.0) / 10.0;
-    doc["moisture"] = moistureError ? 0 : moisture;
-    doc["pumpState"] = pumpState ? 1 : 0;
+    JsonWriter json(output, size);
+    json.fixed(KEY_TEMPERATURE, temperatureError ? 0 : lroundf(snapshot.temperature * 10), 1);
+    json.fixed(KEY_HUMIDITY, humidityError ? 0 : lroundf(snapshot.humidity * 10), 1);
+    json.integer(KEY_MOISTURE, moistureError ? 0 : snapshot.moisture);
+    json.integer(KEY_PUMP_STATE, pumpState ? 1 : 0);
     
     // Add error flags
-    doc["temperature_error"] = temperatureError;
-    doc["humidity_error"] = humidityError;
-    doc["moisture_error"] = moistureError;
+    json.boolean(KEY_TEMPERATURE_ERROR, temperatureError);
+    json.boolean(KEY_HUMIDITY_ERROR, humidityError);
+    json.boolean(KEY_MOISTURE_ERROR, moistureError);
+    
+    return json.finish() ? json.length() : 0;
+}
+
+void buildSensorFrame(SensorFrame &frame) {
+    const SensorSnapshot &snapshot = getSensorSnapshot();
+    
+    frame.version = SENSOR_FRAME_VERSION;
+    frame.flags = sensorFlags();
+    frame.sequence = sensorFrameSequence;
+    frame.temperature = temperatureError ? 0 : lroundf(snapshot.temperature * 10);
+    frame.humidity = humidityError ? 0 : lroundf(snapshot.humidity * 10);
+    frame.moisture = moistureError ? 0 : snapshot.moisture;
+}
+
+// Sends the current readings to a single client in its negotiated format
+void sendSensorDataTo(AsyncWebSocketClient *client) {
+    if (!sensorSnapshot.valid) {
+        return;  // The first tick broadcasts to every client
+    }
+    if (isWsClientBinary(client->id())) {
+        SensorFrame frame;
+        buildSensorFrame(frame);
+        client->binary((uint8_t *)&frame, sizeof(frame));
+    } else {
+        char output[SENSOR_JSON_SIZE];
+        size_t len = buildSensorJson(output, sizeof(output));
+        if (len) {
+            client->text(output, len);
+        }
+    }
+}
+
+void sendSensorData() {
+    if (!sensorSnapshot.valid) {
+        return;
+    }
+    sensorFrameSequence++;
+    
+    if (wsClientCount > 0 && wsBinaryCount == 0) {
+        // JSON only: serialize once into a message buffer that every client
+        // queue references instead of copying; the library frees it after
+        // the last client has sent it
+        char output[SENSOR_JSON_SIZE];
+        size_t len = buildSensorJson(output, sizeof(output));
+        if (len) {
+            ws.textAll(ws.makeBuffer((uint8_t *)output, len));
+        }
+    } else if (wsClientCount > 0) {
+        // Mixed or binary: encode each format once, send per negotiated mode
+        SensorFrame frame;
+        buildSensorFrame(frame);
+        char output[SENSOR_JSON_SIZE];
+        size_t len = wsClientCount > wsBinaryCount ? buildSensorJson(output, sizeof(output)) : 0;
+        
+        for (uint8_t i = 0; i < wsClientCount; i++) {
+            if (wsClients[i].binary) {
+                ws.binary(wsClients[i].id, (uint8_t *)&frame, sizeof(frame));
+            } else if (len) {
+                ws.text(wsClients[i].id, output, len);
+            }
+        }
+    }
     
-    String output;
-    serializeJson(doc, output);
-    ws.textAll(output);
+    const SensorSnapshot &snapshot = getSensorSnapshot();
+    lastSentFrame = {snapshot.temperature, snapshot.humidity, snapshot.moisture,
+                     sensorFlags(), millis(), true};
     
     // Log values to Serial
-    Serial.println("Sensor Readings:");
-    Serial.printf("Temperature: %.1f°C (Error: %s)\n", temperature, temperatureError ? "Yes" : "No");
-    Serial.printf("Humidity: %.1f%% (Error: %s)\n", humidity, humidityError ? "Yes" : "No");
-    Serial.printf("Moisture: %d%% (Error: %s)\n", moisture, moistureError ? "Yes" : "No");
-    Serial.printf("Pump State: %s\n", pumpState ? "ON" : "OFF");
-    Serial.println("------------------------");
-} 
\ No newline at end of file
+    LOG_INFO(logger, MODULE_SENSOR, "Temperature: %.1f°C (Error: %S)", snapshot.temperature, temperatureError ? PSTR("Yes") : PSTR("No"));
+    LOG_INFO(logger, MODULE_SENSOR, "Humidity: %.1f%% (Error: %S)", snapshot.humidity, humidityError ? PSTR("Yes") : PSTR("No"));
+    LOG_INFO(logger, MODULE_SENSOR, "Moisture: %d%% (Error: %S)", snapshot.moisture, moistureError ? PSTR("Yes") : PSTR("No"));
+    LOG_INFO(logger, MODULE_SENSOR, "Pump State: %S", pumpState ? PSTR("ON") : PSTR("OFF"));
+    LOG_DEBUG(logger, MODULE_SENSOR, "Sensor reads: %lu", sensorReads);
+    LOG_DEBUG(logger, MODULE_SENSOR, "Update interval: %lu ms, %lu frames skipped", currentUpdateInterval, framesSkipped);
+    LOG_INFO(logger, MODULE_HEAP, "Heap: %u bytes free, %u clients", ESP.getFreeHeap(), ws.count());
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#ifndef HEAP_METRICS_H
+#define HEAP_METRICS_H
+
+#include <Arduino.h>
+
+// Set HEAP_METRICS to 0 to compile the tracker and every HEAP_SCOPE out
+#ifndef HEAP_METRICS
+#define HEAP_METRICS 1
+#endif
+
+// Net heap change of one subsystem, attributed with HEAP_SCOPE. Memory a
+// scope allocates and something else frees later (a queued response, an
+// SSE frame sent after the handler returns) shows up as allocated here and
+// is not released against the subsystem.
+struct HeapSubsystemStats {
+    uint32_t calls;
+    uint32_t allocations;     // scopes that left less heap free
+    uint32_t allocatedBytes;
+    uint32_t releasedBytes;
+};
+
+// Samples free heap, largest free block and fragmentation, keeping their
+// worst values since boot, and per-subsystem heap deltas. Subsystem names
+// are PROGMEM strings.
+template <uint8_t SUBSYSTEMS>
+class HeapMetrics {
+public:
+    explicit HeapMetrics(const char *const *names) : _names(names) {}
+
+    // getMaxFreeBlockSize() walks the free list: call this periodically,
+    // not on every loop pass
+    void sample() {
+        _free = ESP.getFreeHeap();
+        _maxBlock = ESP.getMaxFreeBlockSize();
+        _fragmentation = ESP.getHeapFragmentation();
+        if (_samples == 0 || _free < _minFree) _minFree = _free;
+        if (_samples == 0 || _maxBlock < _minMaxBlock) _minMaxBlock = _maxBlock;
+        if (_fragmentation > _maxFragmentation) _maxFragmentation = _fragmentation;
+        _samples++;
+    }
+
+    void account(uint8_t subsystem, uint32_t freeBefore) {
+        HeapSubsystemStats &s = _stats[subsystem];
+        int32_t used = (int32_t)(freeBefore - ESP.getFreeHeap());
+        s.calls++;
+        if (used > 0) {
+            s.allocations++;
+            s.allocatedBytes += used;
+        } else {
+            s.releasedBytes += -used;
+        }
+    }
+
+    uint32_t free() const { return _free; }
+    uint32_t minFree() const { return _minFree; }
+    uint32_t maxBlock() const { return _maxBlock; }
+    uint32_t minMaxBlock() const { return _minMaxBlock; }
+    uint8_t fragmentation() const { return _fragmentation; }
+    uint8_t maxFragmentation() const { return _maxFragmentation; }
+    const HeapSubsystemStats &stats(uint8_t subsystem) const { return _stats[subsystem]; }
+
+    static constexpr uint16_t lineCount() {
+        return 2 * 6 + 4 * (1 + SUBSYSTEMS);
+    }
+
+    // Writes line n of the Prometheus text exposition into out; returns its
+    // length, or 0 once past the last line
+    size_t formatLine(uint16_t n, char *out, size_t size) const {
+        if (n < 12) {
+            static const char *const gauges[] = {
+                "heap_free_bytes", "heap_free_min_bytes",
+                "heap_max_block_bytes", "heap_max_block_min_bytes",
+                "heap_fragmentation_percent", "heap_fragmentation_max_percent"
+            };
+            const uint32_t values[] = {
+                _free, _minFree, _maxBlock, _minMaxBlock, _fragmentation, _maxFragmentation
+            };
+            if (n % 2 == 0) {
+                return snprintf(out, size, "# TYPE %s gauge\n", gauges[n / 2]);
+            }
+            return snprintf(out, size, "%s %lu\n", gauges[n / 2], (unsigned long)values[n / 2]);
+        }
+        n -= 12;
+
+        static const char *const counters[] = {
+            "heap_scope_calls_total", "heap_scope_allocations_total",
+            "heap_scope_allocated_bytes_total", "heap_scope_released_bytes_total"
+        };
+        uint8_t family = n / (1 + SUBSYSTEMS);
+        uint8_t line = n % (1 + SUBSYSTEMS);
+        if (family >= 4) {
+            return 0;
+        }
+        if (line == 0) {
+            return snprintf(out, size, "# TYPE %s counter\n", counters[family]);
+        }
+        const HeapSubsystemStats &s = _stats[line - 1];
+        const uint32_t values[] = {s.calls, s.allocations, s.allocatedBytes, s.releasedBytes};
+        char name[24];
+        strlcpy_P(name, _names[line - 1], sizeof(name));
+        return snprintf(out, size, "%s{subsystem=\"%s\"} %lu\n", counters[family], name,
+                        (unsigned long)values[family]);
+    }
+
+private:
+    const char *const *_names;
+    HeapSubsystemStats _stats[SUBSYSTEMS] = {};
+    uint32_t _samples = 0;
+    uint32_t _free = 0;
+    uint32_t _minFree = 0;
+    uint32_t _maxBlock = 0;
+    uint32_t _minMaxBlock = 0;
+    uint8_t _fragmentation = 0;
+    uint8_t _maxFragmentation = 0;
+};
+
+// Accounts the heap change from construction to the end of the scope
+template <class Metrics>
+class HeapScope {
+public:
+    HeapScope(Metrics &metrics, uint8_t subsystem)
+        : _metrics(metrics), _subsystem(subsystem), _freeBefore(ESP.getFreeHeap()) {}
+    ~HeapScope() { _metrics.account(_subsystem, _freeBefore); }
+
+private:
+    Metrics &_metrics;
+    uint8_t _subsystem;
+    uint32_t _freeBefore;
+};
+
+#if HEAP_METRICS
+#define HEAP_SCOPE(metrics, subsystem) HeapScope<decltype(metrics)> heapScope_##subsystem(metrics, subsystem)
+#else
+#define HEAP_SCOPE(metrics, subsystem) do {} while (0)
+#endif
+
+#endif
\ No newline at end of file
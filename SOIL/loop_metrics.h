@@ -0,0 +1,205 @@
+#ifndef LOOP_METRICS_H
+#define LOOP_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Set LOOP_METRICS to 0 to compile every LOOP_PROBE out
+#ifndef LOOP_METRICS
+#define LOOP_METRICS 1
+#endif
+
+#ifdef ARDUINO
+#include <Arduino.h>
+inline uint32_t loopCycles() { return ESP.getCycleCount(); }
+inline uint32_t loopCyclesPerMicro() { return ESP.getCpuFreqMHz(); }
+#else
+#include <chrono>
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef memcpy_P
+#define memcpy_P memcpy
+#endif
+#ifndef strlen_P
+#define strlen_P strlen
+#endif
+// Host "cycles" are steady clock nanoseconds (differences wrap like ccount)
+inline uint32_t loopCycles() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+inline uint32_t loopCyclesPerMicro() { return 1000; }
+#endif
+
+// Log2 histogram: bucket i counts stages under 2^(i + LOOP_METRICS_SHIFT)
+// cycles (0.8us, 1.6us, ... 210ms at 80 MHz), the last bucket everything longer
+#define LOOP_METRICS_BUCKETS 20
+#define LOOP_METRICS_SHIFT 6
+
+struct LoopStageStats {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t buckets[LOOP_METRICS_BUCKETS];
+};
+
+// Cycle-count timing of the stages of loop(). A probe costs two cycle
+// counter reads and one record(); stage names are PROGMEM strings.
+template <uint8_t STAGES>
+class LoopMetrics {
+public:
+    explicit LoopMetrics(const char *const *names) : _names(names) {
+        reset();
+    }
+
+    void reset() {
+        memset(_stats, 0, sizeof(_stats));
+        for (LoopStageStats &s : _stats) {
+            s.min = UINT32_MAX;
+        }
+    }
+
+    void record(uint8_t stage, uint32_t cycles) {
+        add(_stats[stage], cycles);
+    }
+
+    // Times empty probes so the cost of the instrumentation itself is known
+    void calibrate() {
+        LoopStageStats scratch = {};
+        uint32_t best = UINT32_MAX;
+        for (uint8_t i = 0; i < 8; i++) {
+            uint32_t start = loopCycles();
+            add(scratch, loopCycles() - start);
+            uint32_t elapsed = loopCycles() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        _probeCycles = best;
+    }
+
+    const LoopStageStats &stats(uint8_t stage) const { return _stats[stage]; }
+    uint32_t probeCycles() const { return _probeCycles; }
+
+    static constexpr uint16_t lineCount() {
+        return 1 + STAGES * (LOOP_METRICS_BUCKETS + 2) + 2 * (1 + STAGES) + 2;
+    }
+
+    // Writes line n of the Prometheus text exposition into out; returns its
+    // length, or 0 once past the last line
+    size_t formatLine(uint16_t n, char *out, size_t size) const {
+        const uint16_t perStage = LOOP_METRICS_BUCKETS + 2;
+        char name[24];
+        double scale = 1e-6 / loopCyclesPerMicro();
+
+        if (n == 0) {
+            return snprintf(out, size, "# TYPE loop_stage_seconds histogram\n");
+        }
+        n -= 1;
+        if (n < STAGES * perStage) {
+            uint8_t stage = n / perStage;
+            uint8_t line = n % perStage;
+            const LoopStageStats &s = _stats[stage];
+            stageName(name, sizeof(name), stage);
+            if (line < LOOP_METRICS_BUCKETS - 1) {
+                uint32_t cumulative = 0;
+                for (uint8_t i = 0; i <= line; i++) {
+                    cumulative += s.buckets[i];
+                }
+                return snprintf(out, size, "loop_stage_seconds_bucket{stage=\"%s\",le=\"%.4g\"} %lu\n",
+                                name, (double)(1UL << (line + LOOP_METRICS_SHIFT)) * scale,
+                                (unsigned long)cumulative);
+            }
+            if (line == LOOP_METRICS_BUCKETS - 1) {
+                return snprintf(out, size, "loop_stage_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %lu\n",
+                                name, (unsigned long)s.count);
+            }
+            if (line == LOOP_METRICS_BUCKETS) {
+                return snprintf(out, size, "loop_stage_seconds_sum{stage=\"%s\"} %.9g\n",
+                                name, (double)s.total * scale);
+            }
+            return snprintf(out, size, "loop_stage_seconds_count{stage=\"%s\"} %lu\n",
+                            name, (unsigned long)s.count);
+        }
+        n -= STAGES * perStage;
+
+        // min and max gauges, one family each
+        for (uint8_t family = 0; family < 2; family++) {
+            const char *metric = family == 0 ? "loop_stage_min_seconds" : "loop_stage_max_seconds";
+            if (n == 0) {
+                return snprintf(out, size, "# TYPE %s gauge\n", metric);
+            }
+            n -= 1;
+            if (n < STAGES) {
+                const LoopStageStats &s = _stats[n];
+                uint32_t value = family == 0 ? (s.count ? s.min : 0) : s.max;
+                stageName(name, sizeof(name), n);
+                return snprintf(out, size, "%s{stage=\"%s\"} %.9g\n", metric, name, value * scale);
+            }
+            n -= STAGES;
+        }
+
+        if (n == 0) {
+            return snprintf(out, size, "# TYPE loop_probe_overhead_seconds gauge\n");
+        }
+        if (n == 1) {
+            return snprintf(out, size, "loop_probe_overhead_seconds %.9g\n", _probeCycles * scale);
+        }
+        return 0;
+    }
+
+    // One human-readable line per stage for the serial console
+    size_t formatSummary(uint8_t stage, char *out, size_t size) const {
+        const LoopStageStats &s = _stats[stage];
+        char name[24];
+        double micros = 1.0 / loopCyclesPerMicro();
+        stageName(name, sizeof(name), stage);
+        return snprintf(out, size, "%-14s n=%lu min=%.1fus mean=%.1fus max=%.1fus\n", name,
+                        (unsigned long)s.count, (s.count ? s.min : 0) * micros,
+                        s.count ? (double)s.total / s.count * micros : 0.0, s.max * micros);
+    }
+
+private:
+    static void add(LoopStageStats &s, uint32_t cycles) {
+        s.count++;
+        s.total += cycles;
+        if (cycles < s.min) s.min = cycles;
+        if (cycles > s.max) s.max = cycles;
+        int bucket = cycles ? 32 - __builtin_clz(cycles) - LOOP_METRICS_SHIFT : 0;
+        s.buckets[bucket < 0 ? 0 : (bucket >= LOOP_METRICS_BUCKETS ? LOOP_METRICS_BUCKETS - 1 : bucket)]++;
+    }
+
+    void stageName(char *name, size_t size, uint8_t stage) const {
+        size_t len = strlen_P(_names[stage]);
+        if (len >= size) len = size - 1;
+        memcpy_P(name, _names[stage], len);
+        name[len] = '\0';
+    }
+
+    const char *const *_names;
+    LoopStageStats _stats[STAGES];
+    uint32_t _probeCycles = 0;
+};
+
+// Records the time from construction to the end of the enclosing scope
+template <class Metrics>
+class LoopProbe {
+public:
+    LoopProbe(Metrics &metrics, uint8_t stage) : _metrics(metrics), _stage(stage), _start(loopCycles()) {}
+    ~LoopProbe() { _metrics.record(_stage, loopCycles() - _start); }
+
+private:
+    Metrics &_metrics;
+    uint8_t _stage;
+    uint32_t _start;
+};
+
+#if LOOP_METRICS
+#define LOOP_PROBE(metrics, stage) LoopProbe<decltype(metrics)> loopProbe_##stage(metrics, stage)
+#else
+#define LOOP_PROBE(metrics, stage) do {} while (0)
+#endif
+
+#endif
\ No newline at end of file
@@ -1,288 +1,194 @@
-const char index_html[] PROGMEM = R"rawliteral(
-<!DOCTYPE HTML>
-<html>
-<head>
-    <title>Agriculture Monitoring System</title>
-    <meta name="viewport" content="width=device-width, initial-scale=1">
-    <style>
-        :root {
-            --primary-color: #4CAF50;
-            --error-color: #f44336;
-            --background-color: #f5f5f5;
-            --card-color: #ffffff;
-        }
-        * { box-sizing: border-box; margin: 0; padding: 0; }
-        body {
-            font-family: Arial, sans-serif;
-            background: var(--background-color);
-            color: #333;
-            min-height: 80vh;
-            display: flex;
-            flex-direction: column;
-            padding: 12px;
-        }
-        .header {
-            text-align: center;
-            padding: 8px;
-            margin-bottom: 15px;
-        }
-        .header h1 {
-            color: var(--primary-color);
-            font-size: 20px;
-            margin: 0;
-        }
-        .grid {
-            display: grid;
-            grid-template-columns: repeat(2, 1fr);
-            gap: 15px;
-            padding: 0;
-            max-width: 600px;
-            margin: 0 auto;
-            flex: 1;
-        }
-        .card {
-            background: var(--card-color);
-            border-radius: 12px;
-            padding: 15px;
-            box-shadow: 0 2px 8px rgba(0,0,0,0.08);
-            text-align: center;
-            min-height: 110px;
-            display: flex;
-            flex-direction: column;
-            justify-content: space-between;
-            align-items: center;
-        }
-        .status {
-            padding: 5px 12px;
-            border-radius: 15px;
-            font-size: 13px;
-            display: inline-block;
-            font-weight: 500;
-            margin-bottom: 5px;
-        }
-        .connected { background: rgba(76,175,80,0.1); color: var(--primary-color); }
-        .disconnected { background: rgba(244,67,54,0.1); color: var(--error-color); }
-        .value {
-            font-size: 28px;
-            font-weight: 600;
-            margin: 8px 0;
-            color: #2c3e50;
-        }
-        .error {
-            color: var(--error-color);
-            font-size: 12px;
-            margin-top: 4px;
-            display: none;
-        }
-        .label {
-            color: #666;
-            font-size: 14px;
-            font-weight: 500;
-            display: flex;
-            align-items: center;
-            justify-content: center;
-            gap: 6px;
-        }
-        .label svg {
-            width: 18px;
-            height: 18px;
-        }
-        .switch {
-            position: relative;
-            display: inline-block;
-            width: 52px;
-            height: 28px;
-            margin-top: 10px;
-        }
-        .switch input { opacity: 0; width: 0; height: 0; }
-        .slider {
-            position: absolute;
-            cursor: pointer;
-            top: 0; left: 0; right: 0; bottom: 0;
-            background-color: #ccc;
-            transition: .3s;
-            border-radius: 28px;
-        }
-        .slider:before {
-            position: absolute;
-            content: "";
-            height: 22px;
-            width: 22px;
-            left: 3px;
-            bottom: 3px;
-            background-color: white;
-            transition: .3s;
-            border-radius: 50%;
-        }
-        input:checked + .slider { background-color: var(--primary-color); }
-        input:checked + .slider:before { transform: translateX(24px); }
-        .sensor-error {
-            border: 1px solid var(--error-color);
-        }
-        .sensor-error .value { color: var(--error-color); }
-        .sensor-error .error { display: block; }
-        .pump-timer {
-            font-size: 13px;
-            color: #666;
-            margin-top: 8px;
-            visibility: hidden;
-            font-weight: 500;
-        }
-        .pump-timer.active {
-            visibility: visible;
-            color: var(--primary-color);
-        }
-        @media (max-width: 400px) {
-            .grid { gap: 10px; }
-            .card { padding: 12px; min-height: 100px; }
-            .value { font-size: 24px; }
-        }
-    </style>
-</head>
-<body>
-    <div class="header">
-        <span id="connection-status" class="status connected">Connected</span>
-        <h1>Agriculture Monitoring System</h1>
-    </div>
+// Generated by tools/webui_gen.py from web/index.html - do not edit
+#ifndef WEBUI_H
+#define WEBUI_H
 
-    <div class="grid">
-        <div class="card" id="moisture-card">
-            <div class="label">
-                <svg viewBox="0 0 24 24" fill="currentColor">
-                    <path d="M12,20A6,6 0 0,1 6,14C6,10 12,3.25 12,3.25C12,3.25 18,10 18,14A6,6 0 0,1 12,20Z" />
-                </svg>
-                Soil Moisture
-            </div>
-            <div class="value"><span id="moisture">--</span>%</div>
-            <div class="error">Sensor disconnected</div>
-        </div>
+#define INDEX_HTML_GZ_LEN 2928
+#define INDEX_HTML_ETAG "\"f05ffa5ad65c9b70\""
 
-        <div class="card" id="temperature-card">
-            <div class="label">
-                <svg viewBox="0 0 24 24" fill="currentColor">
-                    <path d="M15,13V5A3,3 0 0,0 12,2A3,3 0 0,0 9,5V13A5,5 0 1,0 15,13M12,4A1,1 0 0,1 13,5V12.1L13.7,12.8C14.5,13.6 15,14.7 15,16A3,3 0 0,1 12,19A3,3 0 0,1 9,16C9,14.7 9.5,13.6 10.3,12.8L11,12.1V5A1,1 0 0,1 12,4Z" />
-                </svg>
-                Temperature
-            </div>
-            <div class="value"><span id="temperature">--</span> C</div>
-            <div class="error">Sensor disconnected</div>
-        </div>
+const uint8_t INDEX_HTML_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xe5, 0x5a, 0x7b, 0x77, 0xda, 0xc8,
+    0x15, 0xff, 0x3f, 0x9f, 0x62, 0xc2, 0xee, 0x16, 0xe8, 0x4a, 0x02, 0xf1, 0x32, 0xc6, 0xe0, 0x5d,
+    0x42, 0x9c, 0x13, 0xf7, 0xd8, 0x4e, 0xce, 0xda, 0xc9, 0x6e, 0xdb, 0xd3, 0x93, 0x1d, 0xa4, 0x01,
+    0xa6, 0x11, 0x12, 0x95, 0x46, 0xc6, 0xd4, 0xeb, 0xef, 0xde, 0x3b, 0x33, 0x12, 0x1a, 0x8d, 0x24,
+    0x6c, 0x37, 0x69, 0xbb, 0xe7, 0x14, 0xe7, 0x80, 0x1e, 0x73, 0x5f, 0xbf, 0xfb, 0x98, 0x7b, 0xa5,
+    0x8c, 0x5f, 0xbe, 0x7e, 0x37, 0xbb, 0xf9, 0xf3, 0xfb, 0x33, 0xf4, 0xf6, 0xe6, 0xf2, 0xe2, 0xf4,
+    0xc5, 0x78, 0xc5, 0xd6, 0x1e, 0xff, 0x21, 0xd8, 0x3d, 0x7d, 0x81, 0xe0, 0x33, 0x66, 0x94, 0x79,
+    0xe4, 0x74, 0xba, 0x0c, 0xa9, 0x13, 0x7b, 0x2c, 0x0e, 0x09, 0xba, 0x0c, 0x7c, 0xca, 0x82, 0x90,
+    0xfa, 0x4b, 0x74, 0xbd, 0x8b, 0x18, 0x59, 0x8f, 0x5b, 0x72, 0x91, 0x24, 0x58, 0x13, 0x86, 0x91,
+    0x8f, 0xd7, 0x64, 0x52, 0xbb, 0xa5, 0x64, 0xbb, 0x09, 0x42, 0x56, 0x43, 0x4e, 0xe0, 0x33, 0xe2,
+    0xb3, 0x49, 0x6d, 0x4b, 0x5d, 0xb6, 0x9a, 0xb8, 0xe4, 0x96, 0x3a, 0xc4, 0x14, 0x27, 0x06, 0xa2,
+    0xc0, 0x8f, 0x62, 0xcf, 0x8c, 0x1c, 0xec, 0x91, 0x89, 0x5d, 0x4b, 0x18, 0x45, 0x6c, 0x97, 0x32,
+    0xe5, 0x9f, 0x51, 0x18, 0x04, 0x0c, 0xdd, 0xef, 0xcf, 0xf9, 0xc7, 0x34, 0x37, 0x21, 0x5d, 0xe3,
+    0x70, 0x67, 0x3a, 0x81, 0x17, 0x84, 0x23, 0xf4, 0x4d, 0x6f, 0x36, 0x7d, 0xd3, 0x6f, 0x9f, 0x68,
+    0xab, 0x48, 0x18, 0x06, 0xe1, 0x7e, 0xcd, 0xa2, 0xd7, 0xeb, 0x76, 0x07, 0xfa, 0x9a, 0x39, 0x76,
+    0x3e, 0x2f, 0xc3, 0x20, 0xf6, 0xdd, 0x6c, 0x61, 0x9f, 0xff, 0xe9, 0x0b, 0x1d, 0x1c, 0x2a, 0x4b,
+    0xc4, 0x27, 0x5b, 0xf2, 0xb0, 0x3f, 0xfa, 0x23, 0xba, 0x47, 0xf3, 0xe0, 0xce, 0x8c, 0xe8, 0x3f,
+    0x01, 0xaa, 0x11, 0x1c, 0x87, 0x2e, 0x09, 0x4d, 0xb8, 0x74, 0x82, 0x40, 0xe5, 0x25, 0xf5, 0x47,
+    0xa8, 0x7d, 0x82, 0x36, 0xd8, 0x75, 0xc5, 0x7d, 0x38, 0xce, 0x88, 0xe7, 0x81, 0xbb, 0xd3, 0x6c,
+    0x5d, 0x00, 0x84, 0xe6, 0x02, 0xaf, 0xa9, 0xb7, 0x1b, 0xa1, 0x69, 0x08, 0x80, 0x19, 0x28, 0xc2,
+    0x7e, 0x64, 0x46, 0x24, 0xa4, 0x8b, 0xbc, 0x92, 0x99, 0x2d, 0x23, 0x74, 0x8b, 0xc3, 0x46, 0xd1,
+    0xba, 0x66, 0x9e, 0x20, 0x35, 0xa7, 0xdb, 0xed, 0xe6, 0x6f, 0xac, 0xa9, 0x6f, 0xae, 0x08, 0x5d,
+    0xae, 0xd8, 0x08, 0x0d, 0xdb, 0xb7, 0xab, 0xfc, 0x5d, 0x97, 0x46, 0x1b, 0x0f, 0x83, 0x3e, 0x0b,
+    0x8f, 0xdc, 0xe5, 0x6f, 0xf1, 0x2b, 0xa6, 0x4b, 0x43, 0xe2, 0x30, 0x1a, 0x80, 0xa9, 0x20, 0x21,
+    0x5e, 0xfb, 0xf9, 0x35, 0x7b, 0xdb, 0xed, 0xce, 0xe6, 0xae, 0x0c, 0x43, 0x8b, 0x07, 0x22, 0x09,
+    0x35, 0x24, 0x18, 0xb9, 0x63, 0x26, 0xf6, 0xe8, 0x92, 0xb3, 0x85, 0xa8, 0x22, 0x61, 0x05, 0xdb,
+    0xe1, 0x46, 0x53, 0x4a, 0xe2, 0x0e, 0x3e, 0x60, 0x2c, 0x58, 0x83, 0xd8, 0xfe, 0x61, 0xb1, 0x2b,
+    0x5b, 0x93, 0x9c, 0xc0, 0x24, 0x21, 0xcd, 0x85, 0x9e, 0x86, 0xa7, 0x70, 0x16, 0x78, 0x9e, 0x8c,
+    0x50, 0xa7, 0x5d, 0xae, 0x05, 0xf7, 0x78, 0x99, 0x6c, 0xc8, 0x34, 0x57, 0x13, 0xbb, 0x87, 0x99,
+    0xdf, 0xcb, 0xf3, 0xe2, 0x57, 0x4c, 0xc8, 0x41, 0xb8, 0xcf, 0x88, 0x29, 0x41, 0x8e, 0x46, 0x28,
+    0x24, 0x1b, 0x82, 0x59, 0xa3, 0x63, 0x20, 0x7b, 0xa1, 0xeb, 0xb6, 0xc4, 0x1b, 0xdd, 0xf4, 0x1c,
+    0x6a, 0x6d, 0x5d, 0xdb, 0x3b, 0x99, 0xa8, 0x23, 0x34, 0x68, 0x57, 0xdb, 0x82, 0x70, 0xcc, 0x82,
+    0x62, 0x08, 0x80, 0xa4, 0x52, 0x2b, 0x79, 0x12, 0x69, 0x56, 0x16, 0x83, 0x36, 0xcb, 0x34, 0xcd,
+    0x84, 0x24, 0x97, 0x42, 0xec, 0xd2, 0x38, 0xd2, 0xc3, 0x27, 0x1f, 0x59, 0x05, 0x3b, 0x45, 0x4e,
+    0xae, 0xb0, 0x1b, 0x6c, 0xb9, 0xd6, 0x40, 0xc9, 0xc3, 0x04, 0x85, 0xcb, 0x39, 0x6e, 0xb4, 0x0d,
+    0xf1, 0x67, 0xb5, 0x87, 0x9a, 0xbc, 0xc7, 0x22, 0x4e, 0xcd, 0x12, 0xdb, 0x2e, 0x80, 0xf4, 0x85,
+    0x69, 0xf2, 0xf7, 0x38, 0x62, 0x74, 0xc1, 0x03, 0x4d, 0x14, 0xd1, 0x11, 0x8a, 0x36, 0x18, 0xaa,
+    0xe7, 0x9c, 0xb0, 0x2d, 0x21, 0xda, 0x5a, 0xa1, 0xa4, 0x49, 0x21, 0x22, 0xa2, 0xa2, 0xaa, 0x0a,
+    0xfe, 0x11, 0xc3, 0x2c, 0x8e, 0x34, 0x0f, 0xec, 0x51, 0x03, 0xd0, 0x4a, 0x40, 0xd5, 0x51, 0x2f,
+    0x40, 0xab, 0x44, 0xbd, 0xdd, 0xad, 0x04, 0x81, 0xfa, 0x1e, 0xf5, 0x41, 0x7d, 0x2f, 0x70, 0x3e,
+    0x97, 0xd0, 0x6f, 0x13, 0x1c, 0xfb, 0xed, 0xf6, 0xc1, 0xe4, 0xad, 0xca, 0x5d, 0x40, 0xc9, 0x07,
+    0x34, 0x89, 0xcb, 0xeb, 0xaf, 0x12, 0x52, 0xc2, 0xc3, 0x47, 0x03, 0xc3, 0x3e, 0xea, 0x1b, 0x43,
+    0xee, 0x65, 0xbb, 0x79, 0x72, 0x30, 0xa1, 0x55, 0xa6, 0xa0, 0xfc, 0x41, 0xbe, 0x9d, 0x5e, 0xcf,
+    0x18, 0x1c, 0x19, 0xfd, 0x5e, 0x19, 0x5f, 0x65, 0xf7, 0xc9, 0x73, 0xbd, 0xc5, 0x5e, 0x4c, 0xca,
+    0xca, 0x7c, 0x52, 0x39, 0x86, 0xa5, 0x00, 0xa7, 0x00, 0x0d, 0xca, 0x01, 0x12, 0x65, 0x4f, 0x4f,
+    0xe2, 0xb4, 0xbe, 0x77, 0x9c, 0x2e, 0xe9, 0x97, 0xd7, 0x1d, 0xa1, 0xe5, 0xa1, 0x7a, 0x97, 0x33,
+    0xa3, 0xd2, 0xef, 0x9d, 0x8a, 0x9a, 0xcb, 0x02, 0xa8, 0x3a, 0xbd, 0xca, 0xa0, 0xf0, 0x03, 0x9f,
+    0x94, 0xaa, 0xe5, 0xe1, 0x39, 0xf1, 0xca, 0xd5, 0xfa, 0x66, 0x30, 0x18, 0x54, 0x2b, 0xd2, 0x3b,
+    0x08, 0x5e, 0x21, 0xba, 0x0e, 0xe4, 0xe8, 0xc1, 0x9c, 0x2a, 0x4d, 0xd0, 0xb2, 0x45, 0xa2, 0xec,
+    0x0e, 0x2a, 0x82, 0x56, 0x5a, 0x19, 0xdd, 0x2e, 0x35, 0x4b, 0x93, 0xc2, 0x6b, 0x17, 0x22, 0x61,
+    0x5f, 0x6d, 0x86, 0x15, 0x1c, 0xa3, 0x2d, 0x65, 0xce, 0x4a, 0x4f, 0xf0, 0x20, 0xa2, 0xb2, 0xce,
+    0x84, 0x04, 0x36, 0x0c, 0x7a, 0x4b, 0x9e, 0x9d, 0xa3, 0x89, 0x46, 0xfd, 0x4e, 0x95, 0x46, 0x9d,
+    0xe1, 0xa1, 0x08, 0xc8, 0x17, 0xc7, 0xa2, 0xbe, 0xd4, 0xdf, 0xc4, 0xd0, 0xe5, 0xa1, 0x00, 0x4a,
+    0x1c, 0x65, 0x3b, 0xd1, 0x16, 0x25, 0x22, 0xe1, 0x28, 0x95, 0x91, 0xeb, 0x95, 0xac, 0xc8, 0xa3,
+    0xc5, 0x26, 0x21, 0x33, 0x15, 0xcf, 0x23, 0x28, 0xaa, 0x4c, 0x33, 0xd5, 0x89, 0xc3, 0x88, 0x07,
+    0xd1, 0x26, 0xa0, 0x45, 0x5f, 0x09, 0x55, 0x41, 0x88, 0x47, 0x16, 0x52, 0x5a, 0xb8, 0x97, 0x9b,
+    0x96, 0x9f, 0x76, 0x55, 0xc7, 0xb5, 0x6f, 0x0d, 0x1d, 0xc7, 0xd1, 0xb8, 0x86, 0xd0, 0xae, 0x25,
+    0x4a, 0x59, 0xdd, 0xe8, 0x60, 0x71, 0xed, 0x54, 0xfa, 0x55, 0x18, 0x3b, 0x9a, 0x93, 0x45, 0x10,
+    0x92, 0xe7, 0xda, 0x9c, 0xc6, 0x67, 0xad, 0x56, 0xe1, 0xbb, 0x82, 0x57, 0x13, 0xec, 0x8b, 0x37,
+    0x24, 0x34, 0xdd, 0xe2, 0x1e, 0x21, 0xe1, 0x29, 0xde, 0x28, 0x00, 0xb4, 0x5d, 0x51, 0x5d, 0xc1,
+    0xe7, 0x20, 0xd4, 0x6f, 0x7f, 0x57, 0x06, 0x90, 0x08, 0xa0, 0x91, 0xb3, 0x22, 0xce, 0x67, 0x28,
+    0xd5, 0xdf, 0x67, 0xd1, 0x51, 0xa2, 0xc1, 0x63, 0x65, 0xbf, 0x82, 0xd7, 0x1e, 0x7c, 0xa9, 0x2f,
+    0x1c, 0x83, 0xc1, 0xe2, 0x90, 0x37, 0x61, 0xbf, 0xc0, 0x66, 0xb0, 0xb9, 0xcb, 0x17, 0xfa, 0x88,
+    0xf8, 0x10, 0x6c, 0x66, 0x59, 0x89, 0x95, 0x56, 0x41, 0x62, 0x40, 0xd1, 0x06, 0x9f, 0x41, 0xef,
+    0x77, 0xa8, 0xda, 0x56, 0xf1, 0x4c, 0xb7, 0x92, 0x27, 0x6e, 0x3c, 0x79, 0xda, 0x44, 0xad, 0x2c,
+    0xfb, 0x65, 0xda, 0xab, 0x04, 0x9b, 0x78, 0xbd, 0x31, 0x19, 0x5d, 0x17, 0xd2, 0xec, 0xe0, 0x96,
+    0x5f, 0x59, 0xa7, 0xd5, 0x8a, 0x50, 0x28, 0x17, 0xb7, 0x34, 0xa2, 0x73, 0xea, 0x89, 0xec, 0x5f,
+    0x51, 0xd7, 0xd5, 0x5b, 0x9c, 0xea, 0x3a, 0x5e, 0xaa, 0xb0, 0x85, 0x1d, 0x5e, 0xe8, 0x34, 0xbd,
+    0x55, 0x21, 0xe2, 0xd8, 0x23, 0x27, 0xcf, 0x6f, 0xf5, 0x33, 0x81, 0x3f, 0xae, 0x89, 0x4b, 0x31,
+    0x6a, 0x28, 0xdd, 0x72, 0x8f, 0x77, 0xcb, 0x4d, 0x4d, 0x6e, 0xd2, 0xde, 0x27, 0x4d, 0x38, 0x2f,
+    0x86, 0x0a, 0x13, 0xa5, 0x33, 0xd6, 0x66, 0xa3, 0x7c, 0x87, 0xd9, 0x2e, 0xa3, 0x4b, 0x23, 0x40,
+    0x6d, 0x20, 0x7a, 0xf9, 0x75, 0xf2, 0x68, 0xdc, 0x4a, 0x26, 0xeb, 0x71, 0x4b, 0xce, 0xf9, 0x63,
+    0x3e, 0x6d, 0x26, 0x43, 0xb7, 0x4b, 0x6f, 0x91, 0xe3, 0xe1, 0x28, 0x9a, 0xd4, 0xe4, 0x10, 0x54,
+    0xcb, 0x26, 0xf0, 0x31, 0xf4, 0x9d, 0x3e, 0xa2, 0xee, 0xa4, 0x96, 0xf4, 0x42, 0x90, 0xa7, 0xa6,
+    0x6c, 0x24, 0x6b, 0x29, 0x51, 0xd2, 0x57, 0xee, 0x9b, 0xa5, 0xda, 0xe9, 0x2c, 0x3d, 0x04, 0xb9,
+    0x40, 0xaf, 0xb0, 0x5b, 0xd9, 0x8f, 0x3d, 0x57, 0x80, 0x15, 0x89, 0xca, 0xa0, 0xd7, 0xe9, 0x8b,
+    0x82, 0x8a, 0x1c, 0x4c, 0x55, 0x41, 0xe5, 0x16, 0x87, 0xb1, 0x26, 0x94, 0x5d, 0x07, 0x34, 0xe2,
+    0x02, 0xc4, 0x38, 0xa1, 0xac, 0xd6, 0x29, 0xc4, 0x1e, 0xac, 0xdd, 0x97, 0x66, 0xc3, 0xb6, 0xcc,
+    0x1f, 0x65, 0xbc, 0x0a, 0xee, 0x26, 0xb5, 0x36, 0x1f, 0x1a, 0x7a, 0xf0, 0xaf, 0x86, 0x16, 0xd4,
+    0xf3, 0x40, 0x50, 0x1c, 0x86, 0x50, 0x54, 0x67, 0x3c, 0x34, 0x4a, 0xa8, 0x05, 0x87, 0x0d, 0x66,
+    0x2b, 0x04, 0xaa, 0x5c, 0xda, 0x1d, 0xa3, 0xd3, 0x9e, 0x0e, 0x8c, 0x01, 0x70, 0x69, 0x1b, 0x36,
+    0x82, 0x76, 0xb4, 0x37, 0x83, 0xaf, 0x36, 0xb8, 0xd9, 0xe8, 0x5a, 0x9d, 0x7e, 0xfa, 0x3b, 0xdb,
+    0x9f, 0x0f, 0xc5, 0x5d, 0xf8, 0xee, 0x29, 0x74, 0x82, 0xcf, 0x5f, 0x6a, 0xa8, 0x55, 0xa2, 0x6e,
+    0x0b, 0xf4, 0x2d, 0x5e, 0xbe, 0x0e, 0xa8, 0x07, 0x10, 0x4b, 0x28, 0xf2, 0x18, 0x48, 0x70, 0xab,
+    0x60, 0x11, 0x71, 0x55, 0x3b, 0xcd, 0x9c, 0x9f, 0xe2, 0x59, 0x3b, 0x35, 0xcd, 0xc4, 0xa7, 0xdf,
+    0x3d, 0xc2, 0x43, 0x54, 0x98, 0xda, 0xe9, 0xb5, 0x28, 0x3b, 0x48, 0x6d, 0xa6, 0x35, 0x42, 0xd5,
+    0xd1, 0xd5, 0x1e, 0xe5, 0xf3, 0x2e, 0x09, 0xf1, 0xef, 0xc6, 0xa9, 0x7d, 0xc3, 0xee, 0x7e, 0xec,
+    0x4f, 0xbb, 0x46, 0x57, 0xb8, 0x47, 0x38, 0xb3, 0xa3, 0x9c, 0x1e, 0x1b, 0xfd, 0x8f, 0x76, 0x77,
+    0xda, 0x37, 0xfa, 0x70, 0xc1, 0xe6, 0xf7, 0x39, 0x05, 0x0f, 0x86, 0xde, 0xd4, 0x06, 0x6f, 0x26,
+    0x3e, 0xed, 0xf2, 0x65, 0x1d, 0xcb, 0xbe, 0xb0, 0xbb, 0xd6, 0x91, 0x01, 0x47, 0xc3, 0x99, 0xdd,
+    0xb3, 0xf8, 0x52, 0x6b, 0x20, 0x48, 0x7a, 0xd6, 0x91, 0xf8, 0x1d, 0xec, 0x79, 0x8b, 0x48, 0xb0,
+    0x8f, 0x95, 0xf3, 0x63, 0xb8, 0x3d, 0x3b, 0x96, 0x6b, 0x8f, 0xf7, 0xc4, 0x6d, 0xab, 0x2b, 0x18,
+    0x5e, 0xd8, 0x36, 0xff, 0xb5, 0x41, 0x5b, 0x45, 0x30, 0xe8, 0xf1, 0xac, 0x58, 0xba, 0xc9, 0xf0,
+    0xff, 0xa2, 0x48, 0x52, 0xfc, 0xa8, 0x04, 0x13, 0x9a, 0xfd, 0x77, 0xa3, 0x69, 0x15, 0xaf, 0xa9,
+    0x0b, 0x1b, 0xc1, 0xef, 0xa4, 0x3e, 0xe4, 0xb2, 0x5f, 0x94, 0x86, 0xb4, 0x48, 0x0c, 0xad, 0x5e,
+    0x87, 0xfb, 0x74, 0x68, 0x74, 0x3a, 0x30, 0xdf, 0xc0, 0xf7, 0x4c, 0x5c, 0xe3, 0xa7, 0x9d, 0x4e,
+    0x72, 0x9f, 0x1f, 0xf4, 0x66, 0xfc, 0x1b, 0xc2, 0x6c, 0x90, 0xd4, 0x10, 0xf9, 0x7b, 0xc9, 0x69,
+    0xd4, 0xea, 0xc3, 0x8b, 0xca, 0x0c, 0xbe, 0x6c, 0xab, 0x0b, 0x81, 0x65, 0x5b, 0x9d, 0x23, 0xe3,
+    0xc8, 0xb2, 0x7b, 0x22, 0x12, 0xad, 0x8e, 0xcd, 0xa3, 0xef, 0xa8, 0x9b, 0x5c, 0xda, 0x2f, 0xd3,
+    0x2b, 0x51, 0xef, 0xb9, 0x95, 0xe8, 0x6d, 0x82, 0xf7, 0x17, 0x85, 0x4e, 0xea, 0xb4, 0xff, 0x49,
+    0x11, 0x7a, 0x34, 0x46, 0x7e, 0x86, 0x3e, 0x30, 0x44, 0xef, 0xa1, 0x07, 0x29, 0xd3, 0x49, 0x0e,
+    0x7b, 0xe9, 0x86, 0x29, 0xe6, 0x9e, 0xb2, 0xb0, 0x92, 0xa3, 0x10, 0xdb, 0x6d, 0x08, 0x88, 0xe5,
+    0x3d, 0xe8, 0x3c, 0xb8, 0x93, 0x11, 0xcb, 0x9b, 0x9b, 0x6b, 0x49, 0x87, 0x02, 0xdf, 0xf1, 0xa8,
+    0xf3, 0x19, 0x92, 0x29, 0x58, 0x2e, 0x3d, 0xc2, 0x65, 0x36, 0x9a, 0xa5, 0x51, 0xca, 0xa1, 0x4b,
+    0x85, 0x8a, 0x3e, 0x16, 0xf0, 0xd4, 0xb6, 0x64, 0x69, 0xbd, 0xd0, 0xaf, 0xc4, 0xc6, 0x54, 0xf4,
+    0x0d, 0x6f, 0xab, 0xf6, 0x3b, 0x7e, 0xd6, 0x69, 0xd5, 0x4e, 0xa7, 0x31, 0x0b, 0xcc, 0x60, 0xb1,
+    0x40, 0xfc, 0x31, 0x44, 0x3f, 0x2a, 0xc7, 0xb5, 0xb0, 0xa1, 0x47, 0x4e, 0x48, 0x37, 0x2c, 0x5b,
+    0x07, 0x3d, 0x17, 0xf4, 0x47, 0x8c, 0x6c, 0xf1, 0x0e, 0x4d, 0xd0, 0xaf, 0xdb, 0x68, 0xd4, 0x6a,
+    0x7d, 0x7b, 0xbf, 0xa5, 0xbe, 0x1b, 0x6c, 0x2d, 0x68, 0x4d, 0x31, 0x6f, 0x3c, 0xac, 0x55, 0x10,
+    0x31, 0xfe, 0x9a, 0xe1, 0xa1, 0xb5, 0x8d, 0x7e, 0x3d, 0xc9, 0x11, 0x6f, 0x09, 0x8c, 0x3f, 0xd0,
+    0xb3, 0xb3, 0xfc, 0xe5, 0x54, 0xf7, 0x20, 0x56, 0x6e, 0x40, 0x10, 0x44, 0x0c, 0xbd, 0xff, 0x70,
+    0xf9, 0xfe, 0xd3, 0xe5, 0xf4, 0x97, 0x4f, 0x37, 0xe7, 0x97, 0x67, 0x20, 0x14, 0xda, 0x4a, 0xa5,
+    0xaf, 0xf4, 0x08, 0x43, 0x60, 0x2c, 0xbb, 0x24, 0x51, 0x84, 0x97, 0x84, 0xf3, 0x80, 0x35, 0xaf,
+    0x41, 0x45, 0xcb, 0x0f, 0xb6, 0x8d, 0xa6, 0xce, 0x6d, 0xf6, 0xee, 0xea, 0xea, 0x6c, 0x76, 0x73,
+    0xfe, 0xee, 0x4a, 0xf0, 0x7b, 0xf7, 0xe1, 0x06, 0x96, 0x43, 0x3b, 0x08, 0x3c, 0x11, 0x6a, 0xb5,
+    0xa0, 0x30, 0x84, 0xeb, 0x2d, 0x86, 0x96, 0x07, 0xfa, 0x70, 0x37, 0x42, 0x18, 0x2d, 0x42, 0x30,
+    0x04, 0x61, 0x90, 0x42, 0x40, 0x0c, 0x22, 0xb7, 0x24, 0xdc, 0x41, 0xa5, 0x47, 0x11, 0x6a, 0x5c,
+    0x9f, 0x5d, 0xbd, 0xfe, 0xf4, 0xf6, 0x6c, 0xfa, 0xd3, 0xcd, 0xab, 0xb3, 0xe9, 0xcd, 0xa7, 0xf3,
+    0xab, 0x9b, 0xb3, 0x9f, 0x3e, 0x4e, 0x2f, 0x9a, 0x59, 0x78, 0x2e, 0x62, 0x5f, 0xb4, 0x62, 0xe2,
+    0x3d, 0xca, 0xcf, 0x64, 0x7e, 0x2d, 0x4c, 0x6f, 0xe8, 0x9d, 0xe7, 0x1e, 0x14, 0xd0, 0xc5, 0x27,
+    0x5b, 0x94, 0xad, 0x4c, 0xb0, 0xd6, 0x1e, 0xea, 0xec, 0xd7, 0x5b, 0x73, 0xea, 0x43, 0xf3, 0x7b,
+    0x03, 0x81, 0x08, 0xa4, 0x75, 0x1c, 0x86, 0x78, 0x37, 0x8f, 0x17, 0x0b, 0x12, 0xd6, 0xab, 0x28,
+    0x02, 0x3f, 0xd8, 0x10, 0x1f, 0x56, 0x83, 0x16, 0x93, 0x53, 0x4d, 0x11, 0xf1, 0xa0, 0x21, 0x70,
+    0xe2, 0x35, 0x54, 0x45, 0x6b, 0x49, 0xd8, 0x99, 0x47, 0xf8, 0xe1, 0xab, 0xdd, 0xb9, 0xdb, 0xa8,
+    0x17, 0x3a, 0xcb, 0x7a, 0xd3, 0x12, 0x81, 0x76, 0x85, 0x05, 0xe8, 0x75, 0xbd, 0xc1, 0xd4, 0x74,
+    0x78, 0x36, 0x73, 0x0a, 0x97, 0x42, 0xfe, 0xf6, 0x8b, 0x33, 0x9f, 0x1d, 0xe0, 0x0a, 0x7e, 0x9b,
+    0x46, 0x9f, 0xa1, 0xbd, 0x0e, 0x41, 0xf8, 0x7a, 0x03, 0x53, 0x05, 0x92, 0xc0, 0x20, 0x39, 0x4d,
+    0x49, 0x27, 0x46, 0x05, 0xba, 0x0c, 0x15, 0xee, 0xed, 0xc6, 0x9f, 0xae, 0xdf, 0x5d, 0x59, 0x11,
+    0xe3, 0x6d, 0x2e, 0x5d, 0xec, 0x1a, 0xf7, 0xc0, 0x6b, 0x8d, 0xf9, 0x73, 0xc4, 0xba, 0xe4, 0x56,
+    0x37, 0x10, 0xd7, 0x8d, 0xcf, 0x53, 0x0f, 0x4d, 0xcd, 0x25, 0x0f, 0xd5, 0x78, 0x3b, 0x5e, 0x10,
+    0x91, 0xff, 0x24, 0xe0, 0x6a, 0xbd, 0xfc, 0xaa, 0x98, 0xbf, 0x3e, 0xcc, 0x38, 0xde, 0xb8, 0x80,
+    0xc6, 0xd4, 0xf3, 0x64, 0xdd, 0x8e, 0xce, 0x78, 0x15, 0x6f, 0xb0, 0x30, 0x26, 0xcd, 0xe2, 0xe2,
+    0x88, 0xb0, 0x24, 0xc1, 0x1b, 0xb9, 0x64, 0x30, 0x50, 0x07, 0x92, 0xef, 0xe9, 0x68, 0xae, 0x65,
+    0xa2, 0x73, 0x3c, 0x21, 0x17, 0x7d, 0x56, 0x01, 0xea, 0xd3, 0x6a, 0x82, 0x5a, 0x82, 0xc0, 0x16,
+    0x0c, 0xcb, 0x04, 0x53, 0x4b, 0x9c, 0x50, 0x28, 0x18, 0xd8, 0x77, 0x48, 0xb0, 0x40, 0x53, 0x9e,
+    0x59, 0xaf, 0x44, 0x66, 0xa1, 0x1f, 0x4a, 0x1b, 0x05, 0x97, 0x38, 0x81, 0x4b, 0x24, 0x12, 0x6f,
+    0x78, 0xb8, 0x35, 0x78, 0x26, 0x83, 0x50, 0xfc, 0x11, 0xfa, 0x8f, 0x46, 0xc6, 0xb6, 0xd9, 0x44,
+    0x23, 0x24, 0x42, 0x6d, 0x83, 0xc3, 0x88, 0xa8, 0x77, 0x8a, 0x8a, 0xd1, 0x05, 0x6a, 0xbc, 0x14,
+    0xf7, 0x50, 0x48, 0xa0, 0x19, 0xf3, 0xab, 0xbc, 0x20, 0x05, 0x7f, 0xe4, 0x7b, 0x71, 0xa3, 0x9e,
+    0x8e, 0x01, 0x10, 0xb0, 0x9c, 0xd6, 0x4a, 0xcf, 0xb5, 0xd3, 0x4f, 0x62, 0xdb, 0x6d, 0x3e, 0x89,
+    0xa5, 0xd2, 0x0f, 0xa6, 0x5c, 0x95, 0x4b, 0xc5, 0x2b, 0xcf, 0xe1, 0x9d, 0x36, 0x0c, 0x29, 0xe3,
+    0xf4, 0x5c, 0x3b, 0xad, 0x64, 0x59, 0x19, 0xe0, 0xd9, 0x66, 0xcc, 0x33, 0x27, 0x79, 0x56, 0x34,
+    0x91, 0x5c, 0xc5, 0x3d, 0x9e, 0xcd, 0x68, 0x32, 0x99, 0xa8, 0x6f, 0xc2, 0xb4, 0xf8, 0x7b, 0xc8,
+    0xaa, 0x39, 0x94, 0x99, 0x57, 0xc5, 0xb2, 0x62, 0x40, 0xac, 0xed, 0x20, 0xac, 0x21, 0x5c, 0xd0,
+    0xf5, 0xbb, 0xf3, 0x0b, 0x48, 0xa1, 0x00, 0xf6, 0x86, 0x2c, 0x10, 0x9a, 0xc5, 0xed, 0xa0, 0x18,
+    0x2c, 0xbc, 0x49, 0xd5, 0xb7, 0x05, 0xee, 0x7c, 0x7e, 0xdd, 0x9a, 0xef, 0x18, 0xb9, 0x20, 0xfe,
+    0x12, 0x3a, 0xd1, 0x31, 0x3a, 0x46, 0xbf, 0xfd, 0x26, 0x7a, 0x5a, 0x6e, 0xee, 0x07, 0xea, 0xb3,
+    0x61, 0xa3, 0xdd, 0x44, 0x2f, 0xb9, 0x11, 0x69, 0x90, 0x20, 0x3f, 0xf6, 0xbc, 0xc2, 0xf3, 0x45,
+    0xd8, 0xbd, 0x16, 0x1e, 0x5e, 0x46, 0x80, 0x40, 0x9e, 0xdc, 0xd6, 0x30, 0x4d, 0x98, 0xdc, 0x97,
+    0xe4, 0xf0, 0x3f, 0x62, 0x02, 0x09, 0x31, 0xca, 0x31, 0xb0, 0x07, 0xfc, 0x65, 0xa6, 0x48, 0x7b,
+    0xa3, 0x40, 0xa2, 0x84, 0xc4, 0x28, 0xb1, 0x06, 0xc8, 0xce, 0x05, 0x55, 0x2f, 0xa1, 0x42, 0x2d,
+    0x98, 0x82, 0x9a, 0x16, 0x0b, 0xde, 0xd0, 0x3b, 0xe2, 0x82, 0x3a, 0x45, 0x36, 0x69, 0x0c, 0x28,
+    0x3c, 0x12, 0xd1, 0x83, 0xa7, 0x33, 0x49, 0xe3, 0x7e, 0xa4, 0xd9, 0x3f, 0x2c, 0x59, 0xbb, 0x0f,
+    0x8f, 0x51, 0x02, 0xda, 0x1f, 0x50, 0xfb, 0xae, 0x6d, 0x1f, 0x34, 0x50, 0x06, 0x28, 0xa8, 0xa8,
+    0x50, 0x74, 0xa4, 0x6b, 0xda, 0xd5, 0x26, 0x95, 0x51, 0xf5, 0x2a, 0xa9, 0xf2, 0xb9, 0x9b, 0xa7,
+    0x1a, 0x26, 0x54, 0x4f, 0x08, 0xe5, 0x7d, 0x24, 0x96, 0xd7, 0xf0, 0x15, 0x96, 0x07, 0x7a, 0x44,
+    0xfe, 0x55, 0x2d, 0x2d, 0x5a, 0x4d, 0xc8, 0xd2, 0xf8, 0x6f, 0x16, 0xec, 0xc4, 0x67, 0xd8, 0x59,
+    0x35, 0x64, 0x9e, 0x9c, 0xbb, 0xe5, 0x35, 0x5a, 0xc6, 0xa4, 0x78, 0xa8, 0x36, 0xa9, 0x4c, 0xe2,
+    0x3d, 0x8b, 0xef, 0x51, 0x5d, 0x8c, 0x81, 0xf5, 0x92, 0x0a, 0x20, 0x39, 0x11, 0x49, 0xf6, 0x04,
+    0x66, 0x15, 0x95, 0xb6, 0xca, 0xec, 0xf4, 0x93, 0x08, 0xc8, 0x6f, 0x92, 0xa6, 0x59, 0xb2, 0x35,
+    0x0a, 0xa5, 0x40, 0x59, 0xb9, 0x5f, 0x5f, 0x00, 0x66, 0x16, 0x76, 0xa1, 0x22, 0xa9, 0x4f, 0x77,
+    0xcb, 0x0c, 0xc9, 0x3f, 0x38, 0x7c, 0x68, 0x3e, 0xc5, 0x79, 0x6a, 0x2d, 0x4d, 0x0d, 0x34, 0x90,
+    0x18, 0xcb, 0x0c, 0x54, 0x65, 0xd2, 0x17, 0x22, 0xf6, 0x75, 0x5c, 0xf7, 0x18, 0xe6, 0x4f, 0xc7,
+    0xfb, 0xb9, 0x58, 0x3f, 0x00, 0xef, 0x88, 0x3c, 0x51, 0xa4, 0x80, 0xf2, 0x51, 0x99, 0x21, 0x59,
+    0x07, 0xb7, 0xe4, 0x11, 0xb1, 0x07, 0xdd, 0xa9, 0x8e, 0x89, 0xa5, 0xee, 0xca, 0xf6, 0xb3, 0x03,
+    0xa8, 0xe7, 0x76, 0xbd, 0x93, 0x0a, 0x2e, 0x62, 0x4e, 0x7c, 0x8c, 0x89, 0x58, 0xa4, 0xf3, 0x28,
+    0x38, 0x30, 0x13, 0x97, 0x6e, 0xb1, 0x65, 0xae, 0xe4, 0x73, 0x1a, 0x9f, 0x44, 0x2f, 0xc8, 0x82,
+    0x87, 0x5b, 0xff, 0xa4, 0xb4, 0xe2, 0x0a, 0x89, 0xba, 0x1f, 0xe5, 0x4b, 0x82, 0xb2, 0x6c, 0xa9,
+    0xaa, 0x28, 0x41, 0xec, 0x33, 0x18, 0x48, 0xf9, 0x94, 0x13, 0x89, 0xcd, 0x86, 0x84, 0xe0, 0xc3,
+    0x46, 0x55, 0x03, 0x2e, 0xca, 0x78, 0xa2, 0x9b, 0x69, 0x96, 0x27, 0x73, 0xa6, 0x1d, 0xff, 0x0f,
+    0x27, 0x33, 0xf9, 0xb6, 0x8e, 0x8f, 0xc0, 0xb9, 0xb9, 0xfa, 0xdb, 0xfb, 0x94, 0xcf, 0x83, 0x3a,
+    0xf8, 0xea, 0x90, 0xed, 0x81, 0x18, 0x43, 0xb5, 0xae, 0x2a, 0x36, 0xc2, 0x1e, 0x18, 0x3a, 0xc3,
+    0xbd, 0xfe, 0x7b, 0xbb, 0x9a, 0x27, 0x95, 0x14, 0x45, 0x6f, 0x80, 0x92, 0x0b, 0x0c, 0xc1, 0x7e,
+    0x98, 0x46, 0x47, 0x3e, 0x8d, 0xe6, 0x6a, 0xf0, 0x9f, 0x3d, 0x44, 0x71, 0x31, 0xd9, 0x08, 0xd5,
+    0x2e, 0x8c, 0x50, 0xe5, 0x35, 0x50, 0x5c, 0x31, 0xf8, 0x8b, 0x15, 0x3e, 0x24, 0x94, 0x96, 0x6d,
+    0xe5, 0xe1, 0x41, 0x53, 0x42, 0x96, 0x4e, 0x1a, 0xea, 0x9d, 0xea, 0x88, 0xe3, 0xcd, 0xdb, 0x44,
+    0x1d, 0x50, 0x0e, 0x05, 0xca, 0xf3, 0x5c, 0xf2, 0xef, 0x41, 0x0b, 0xf6, 0xe6, 0x9e, 0x7a, 0x3c,
+    0xb5, 0x78, 0x7d, 0x0d, 0x30, 0x9e, 0xae, 0xe9, 0xc3, 0x8b, 0xaf, 0x10, 0x06, 0x25, 0xf1, 0xfa,
+    0x03, 0xb2, 0x91, 0x1e, 0x1f, 0x4a, 0xb9, 0x7c, 0x2c, 0xa3, 0x39, 0x08, 0xd9, 0xac, 0x87, 0xcc,
+    0xc2, 0x28, 0x78, 0x5a, 0xf2, 0x10, 0xa8, 0xf9, 0x7f, 0x39, 0x97, 0x2b, 0xdb, 0x51, 0x31, 0xc3,
+    0x92, 0x87, 0x7a, 0x50, 0x82, 0xcf, 0xf8, 0x84, 0xca, 0x03, 0x82, 0x80, 0x0e, 0x8d, 0xba, 0x17,
+    0x60, 0xb7, 0x6e, 0xe4, 0x1f, 0x69, 0x25, 0x8c, 0xc7, 0xad, 0xf4, 0x81, 0xe1, 0xb8, 0x25, 0xdf,
+    0x5c, 0x8e, 0x5b, 0xf2, 0xff, 0x2d, 0xff, 0x0b, 0x47, 0x07, 0xa8, 0x36, 0xcf, 0x2c, 0x00, 0x00,
+};
 
-        <div class="card" id="humidity-card">
-            <div class="label">
-                <svg viewBox="0 0 24 24" fill="currentColor">
-                    <path d="M12,3.25C12,3.25 6,10 6,14C6,18.42 9.58,22 14,22C18.42,22 22,18.42 22,14C22,10 16,3.25 16,3.25M14,20A6,6 0 0,1 8,14C8,11.37 11.27,7.14 13,5.21C14.73,7.14 18,11.37 18,14A6,6 0 0,1 14,20Z" />
-                </svg>
-                Humidity
-            </div>
-            <div class="value"><span id="humidity">--</span>%</div>
-            <div class="error">Sensor disconnected</div>
-        </div>
-
-        <div class="card">
-            <div class="label">Water Pump</div>
-            <label class="switch">
-                <input type="checkbox" id="pumpSwitch" onclick="togglePump()">
-                <span class="slider"></span>
-            </label>
-            <div id="pumpTimer" class="pump-timer">Auto-off in: 5s</div>
-        </div>
-    </div>
-
-    <script>
-        var gateway = `ws://${window.location.hostname}/ws`;
-        var websocket;
-        var pumpTimeout;
-        const PUMP_MAX_TIME = 5000;
-        let lastMessageTime = Date.now();
-        const CONNECTION_TIMEOUT = 5000;
-
-        function initWebSocket() {
-            websocket = new WebSocket(gateway);
-            websocket.onopen = () => {
-                document.getElementById('connection-status').className = 'status connected';
-                document.getElementById('connection-status').innerHTML = 'Connected';
-            };
-            websocket.onclose = () => {
-                document.getElementById('connection-status').className = 'status disconnected';
-                document.getElementById('connection-status').innerHTML = 'Disconnected';
-                updateAllSensorsError(true);
-                setTimeout(initWebSocket, 2000);
-            };
-            websocket.onmessage = (event) => {
-                lastMessageTime = Date.now();
-                var data = JSON.parse(event.data);
-                updateSensorValue('moisture', data.moisture, data.moisture_error);
-                updateSensorValue('temperature', data.temperature, data.temperature_error);
-                updateSensorValue('humidity', data.humidity, data.humidity_error);
-                document.getElementById('pumpSwitch').checked = data.pumpState === 1;
-            };
-        }
-
-        function updateAllSensorsError(hasError) {
-            ['moisture', 'temperature', 'humidity'].forEach(sensorId => {
-                const card = document.getElementById(sensorId + '-card');
-                const element = document.getElementById(sensorId);
-                if (hasError) {
-                    element.innerHTML = '--';
-                    card.classList.add('sensor-error');
-                }
-            });
-        }
-
-        function updateSensorValue(sensorId, value, hasError) {
-            const element = document.getElementById(sensorId);
-            const card = document.getElementById(sensorId + '-card');
-            if (hasError) {
-                element.innerHTML = '--';
-                card.classList.add('sensor-error');
-            } else {
-                element.innerHTML = value;
-                card.classList.remove('sensor-error');
-            }
-        }
-
-        function togglePump() {
-            const pumpSwitch = document.getElementById('pumpSwitch');
-            const pumpTimer = document.getElementById('pumpTimer');
-            
-            if (pumpSwitch.checked) {
-                let timeLeft = 5;
-                pumpTimer.classList.add('active');
-                
-                const countdown = setInterval(() => {
-                    timeLeft--;
-                    pumpTimer.textContent = `Auto-off in: ${timeLeft}s`;
-                    if (timeLeft <= 0) {
-                        clearInterval(countdown);
-                        pumpSwitch.checked = false;
-                        pumpTimer.classList.remove('active');
-                        websocket.send(JSON.stringify({command: 'pump', state: 0}));
-                    }
-                }, 1000);
-
-                if (pumpTimeout) clearTimeout(pumpTimeout);
-                pumpTimeout = setTimeout(() => {
-                    clearInterval(countdown);
-                    pumpTimer.classList.remove('active');
-                }, PUMP_MAX_TIME);
-            } else {
-                if (pumpTimeout) clearTimeout(pumpTimeout);
-                pumpTimer.classList.remove('active');
-            }
-            websocket.send(JSON.stringify({command: 'pump', state: pumpSwitch.checked ? 1 : 0}));
-        }
-
-        setInterval(() => {
-            if (Date.now() - lastMessageTime > CONNECTION_TIMEOUT) {
-                document.getElementById('connection-status').className = 'status disconnected';
-                document.getElementById('connection-status').innerHTML = 'Disconnected';
-                updateAllSensorsError(true);
-            }
-        }, 1000);
-
-        window.addEventListener('load', initWebSocket);
-    </script>
-</body>
-</html>
-)rawliteral"; 
\ No newline at end of file
+#endif
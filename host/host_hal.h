@@ -0,0 +1,159 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+// Host implementation of hal.h: a virtual microsecond clock, the relay pin
+// and sensor reads routed to the soil/pump simulator (soil_sim.h), and an
+// emulated pair of flash sectors.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// NodeMCU pin names used by config.h
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+#define A0 17
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+
+#ifndef DHT11
+#define DHT11 11
+#endif
+#ifndef DHT22
+#define DHT22 22
+#endif
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#include "config.h"  // after the pin names it uses
+
+// Virtual time, advanced by the simulation driver
+extern uint64_t hostMicros;
+
+// Implemented by the simulator
+int simAnalogRead(uint8_t pin);
+void simDigitalWrite(uint8_t pin, uint8_t level);
+bool simReadDht(float &temperature, float &humidity);
+
+// millis()/micros() are unsigned long as on the board; host unsigned long is
+// 64 bits, so the 49.7 day millis() wrap is not reproduced.
+inline unsigned long halMillis() { return hostMicros / 1000; }
+inline unsigned long halMicros() { return hostMicros; }
+inline int halAnalogRead(uint8_t pin) { return simAnalogRead(pin); }
+inline void halPinMode(uint8_t, uint8_t) {}
+inline void halDigitalWrite(uint8_t pin, uint8_t level) { simDigitalWrite(pin, level); }
+inline void halSleepMode(uint8_t, uint8_t) {}
+inline void halIdle(unsigned long ms) { hostMicros += ms * 1000ULL; }
+
+// Two sectors of NOR flash for config_store.h, defined by the simulation
+// driver: erase sets every bit, a write can only clear bits. Erases and
+// writes advance the clock by typical SPI flash timings. A non-negative
+// hostFlashWordsLeft cuts the power after that many more words have been
+// erased or written: the operation stops there and fails.
+#define HAL_FLASH_SECTOR_SIZE 4096
+#define HOST_FLASH_ERASE_US 45000
+#define HOST_FLASH_WRITE_US 12      // per 4-byte word
+extern uint8_t hostFlash[2 * HAL_FLASH_SECTOR_SIZE];
+extern long hostFlashWordsLeft;
+
+// Words of an operation that happen before the power is cut
+inline size_t hostFlashWords(size_t words) {
+    if (hostFlashWordsLeft < 0) {
+        return words;
+    }
+    size_t done = (size_t)hostFlashWordsLeft < words ? (size_t)hostFlashWordsLeft : words;
+    hostFlashWordsLeft -= done;
+    return done;
+}
+
+inline bool halConfigSectors(uint32_t &first) {
+    first = 0;
+    return true;
+}
+
+inline bool halFlashErase(uint32_t sector) {
+    if (sector >= 2) {
+        return false;
+    }
+    size_t words = hostFlashWords(HAL_FLASH_SECTOR_SIZE / 4);
+    memset(hostFlash + sector * HAL_FLASH_SECTOR_SIZE, 0xFF, words * 4);
+    hostMicros += HOST_FLASH_ERASE_US;
+    return words == HAL_FLASH_SECTOR_SIZE / 4;
+}
+
+inline bool halFlashRead(uint32_t address, uint32_t *data, size_t size) {
+    if (address + size > sizeof(hostFlash)) {
+        return false;
+    }
+    memcpy(data, hostFlash + address, size);
+    return true;
+}
+
+inline bool halFlashWrite(uint32_t address, const uint32_t *data, size_t size) {
+    if (address + size > sizeof(hostFlash)) {
+        return false;
+    }
+    size_t words = hostFlashWords(size / 4);
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < words * 4; i++) {
+        hostFlash[address + i] &= bytes[i];
+    }
+    hostMicros += HOST_FLASH_WRITE_US * words;
+    return words == size / 4;
+}
+
+// Same interface and timing as DhtAsync, values from the simulator
+class HalDht {
+public:
+    HalDht(uint8_t, uint8_t type) : _type(type) {}
+
+    void init() {}
+
+    void begin(unsigned long now) {
+        _cached = _read && now - _startTime < DHT_MIN_INTERVAL;
+        if (!_cached) {
+            _startTime = now;
+        }
+    }
+
+    bool ready(unsigned long now) const {
+        return _cached || now - _startTime >= (_type == DHT11 ? 20UL : 2UL);
+    }
+
+    bool finish() {
+        if (!_cached) {
+            float t, h;
+            _ok = simReadDht(t, h);
+            _read = true;
+            if (_ok) {
+                _temperature = t;
+                _humidity = h;
+            }
+        }
+        return _ok;
+    }
+
+    float temperature() const { return _temperature; }
+    float humidity() const { return _humidity; }
+
+private:
+    uint8_t _type;
+    unsigned long _startTime = 0;
+    bool _read = false;
+    bool _cached = false;
+    bool _ok = false;
+    float _temperature = 0;
+    float _humidity = 0;
+};
+
+#endif
\ No newline at end of file
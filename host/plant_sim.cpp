@@ -0,0 +1,317 @@
+// Runs the plant_monitor control logic against the soil/pump simulator on a
+// virtual clock.
+//
+// Usage: plant_sim [days] [seed] [full|modem|light] [manual hours]
+// Prints a summary and exits non-zero if a safety invariant was violated
+// (pump stopped more than SIM_MAX_STOP_LATENCY after PUMP_TIMEOUT, restart
+// inside PUMP_COOLDOWN) or if, without manual presses, auto mode never
+// started the pump in a run of SIM_AUTO_CHECK_DAYS or more.
+//
+// Manual "pump on" presses are off unless an interval is given; frequent
+// ones keep the soil too wet for auto mode to ever water.
+//
+// The controller runs under the firmware's Scheduler with the same task
+// order. Task run times are modelled by advancing the virtual clock, so the
+// stop latency and per-task lateness reflect a slow publish or DHT transfer
+// delaying the pump timeout. The clock is 32-bit inside the scheduler, so a
+// 90-day run crosses the millis() wrap twice.
+//
+// The power profile decides how the idle time between deadlines is spent,
+// and the run ends with the PowerManager's average current estimate.
+
+#include <stdio.h>
+#include <chrono>
+#include <string.h>
+#include "controller.h"
+#include "power.h"
+#include "scheduler.h"
+#include "soil_sim.h"
+
+// Physics is integrated lazily, at most this far behind the clock for reads
+#define SIM_SYNC_US 100000ULL
+#define SIM_STEP_US 1000000ULL
+
+// Modelled task run times on the ESP8266
+#define SIM_COST_SENSOR_STEP_US 60     // one ADC sample or DHT start pulse
+#define SIM_COST_DHT_TRANSFER_US 4500  // 40-bit DHT read with interrupts off
+#define SIM_COST_AUTO_MODE_US 20
+#define SIM_COST_PUBLISH_US 4000       // log text, history, log record, SSE frame (±50 %)
+#define SIM_COST_WIFI_US 150
+#define SIM_COST_CONSOLE_US 10         // Serial.available() with nothing typed
+
+// Runs at least this long must see auto mode water the soil
+#define SIM_AUTO_CHECK_DAYS 7
+
+// Longest accepted delay from the pump deadline to the relay opening
+#define SIM_MAX_STOP_LATENCY 20
+
+uint64_t hostMicros = 0;
+
+static SoilSim *sim;
+static SimRandom costJitter(7);
+static uint64_t physicsMicros = 0;
+static bool relayOn = false;
+static unsigned long manualInterval = 0;  // ms between manual presses; 0 = none
+static bool manualPress = false;
+
+struct SimStats {
+    unsigned long measurements = 0;
+    unsigned long broadcasts = 0;      // sensor frames past the deadband/heartbeat
+    unsigned long sensorErrors = 0;
+    unsigned long pumpCycles = 0;
+    unsigned long autoStarts = 0;      // pump starts not from a manual press
+    unsigned long violations = 0;
+    unsigned long longestRun = 0;
+    unsigned long maxStopLatency = 0;  // ms past PUMP_TIMEOUT at the stop
+    unsigned long shortestRest = ~0UL;
+    unsigned long lastStart = 0;
+    unsigned long lastStop = 0;
+    double moistureMin = 100;
+    double moistureMax = 0;
+    double secondsDry = 0;      // true moisture below MOISTURE_THRESHOLD_LOW
+    double secondsSaturated = 0; // true moisture above field capacity
+};
+
+static SimStats stats;
+static PlantController controller;
+static Scheduler scheduler;
+static BroadcastDeadband broadcastDeadband;
+static PowerManager power;
+
+enum TaskId : uint8_t {
+    TASK_PUMP_TIMEOUT,
+    TASK_SENSORS,
+    TASK_AUTO_MODE,
+    TASK_PUBLISH,
+    TASK_WIFI,
+    TASK_CONSOLE,
+    TASK_MANUAL
+};
+
+// Integrates the soil model up to the virtual clock
+static void syncPhysics() {
+    while (physicsMicros < hostMicros) {
+        uint64_t step = hostMicros - physicsMicros;
+        if (step > SIM_STEP_US) {
+            step = SIM_STEP_US;
+        }
+        double dt = step / 1e6;
+        sim->step(physicsMicros / 1e6, dt, relayOn);
+        physicsMicros += step;
+
+        double moisture = sim->moisture();
+        if (moisture < stats.moistureMin) stats.moistureMin = moisture;
+        if (moisture > stats.moistureMax) stats.moistureMax = moisture;
+        if (moisture < MOISTURE_THRESHOLD_LOW) stats.secondsDry += dt;
+        if (moisture > SIM_FIELD_CAPACITY) stats.secondsSaturated += dt;
+    }
+}
+
+int simAnalogRead(uint8_t pin) {
+    if (hostMicros - physicsMicros >= SIM_SYNC_US) {
+        syncPhysics();
+    }
+    return pin == SOIL_MOISTURE_PIN ? sim->adc(ADC_MAX) : 0;
+}
+
+void simDigitalWrite(uint8_t pin, uint8_t level) {
+    if (pin == PUMP_RELAY_PIN) {
+        syncPhysics();
+        relayOn = level == (RELAY_ACTIVE_LOW ? LOW : HIGH);
+    }
+}
+
+bool simReadDht(float &temperature, float &humidity) {
+    return sim->dht(temperature, humidity);
+}
+
+static void violation(const char *what, unsigned long value) {
+    stats.violations++;
+    if (stats.violations <= 10) {
+        printf("VIOLATION at %.1f s: %s (%lu ms)\n", hostMicros / 1e6, what, value);
+    }
+}
+
+void onPumpChanged(bool active) {
+    unsigned long now = halMillis();
+    if (active) {
+        if (stats.pumpCycles > 0) {
+            unsigned long rest = now - stats.lastStop;
+            if (rest < stats.shortestRest) stats.shortestRest = rest;
+            if (rest < PUMP_COOLDOWN) violation("pump restarted inside cooldown", rest);
+        }
+        stats.pumpCycles++;
+        if (!manualPress) {
+            stats.autoStarts++;
+        }
+        stats.lastStart = now;
+        scheduler.wakeAt(TASK_PUMP_TIMEOUT, controller.pumpDeadline());
+        scheduler.wake(TASK_SENSORS, now);
+        power.setBusy(true);
+    } else {
+        unsigned long run = now - stats.lastStart;
+        if (run > stats.longestRun) stats.longestRun = run;
+        if (run >= PUMP_TIMEOUT && run - PUMP_TIMEOUT > stats.maxStopLatency) {
+            stats.maxStopLatency = run - PUMP_TIMEOUT;
+        }
+        if (run > PUMP_TIMEOUT + SIM_MAX_STOP_LATENCY) violation("pump ran past timeout", run);
+        stats.lastStop = now;
+        scheduler.cancel(TASK_PUMP_TIMEOUT);
+        scheduler.wake(TASK_AUTO_MODE, now, controller.config.pumpCooldown);
+        power.setBusy(false);
+    }
+}
+
+// The firmware's tasks minus the network, settings and log ones. The log
+// task only wakes while there is text to send, which the simulator does
+// not produce. The controller gets the 64-bit host clock; the scheduler
+// only sees its low 32 bits.
+uint32_t pumpTimeoutTask(uint32_t) {
+    controller.checkPumpTimeout(halMillis());
+    return controller.state.pumpActive ? 1 : SCHED_NEVER;
+}
+
+uint32_t sensorTask(uint32_t now) {
+    controller.startMeasurement(halMillis());
+    hostMicros += SIM_COST_SENSOR_STEP_US;
+    if (controller.updateSensorReadings(halMillis())) {
+        hostMicros += SIM_COST_DHT_TRANSFER_US;
+        stats.measurements++;
+        if (controller.state.sensorError) {
+            stats.sensorErrors++;
+        }
+        scheduler.wake(TASK_AUTO_MODE, now);
+        scheduler.wake(TASK_PUBLISH, now);
+    }
+    return controller.nextStep(halMillis());
+}
+
+uint32_t autoModeTask(uint32_t) {
+    unsigned long now = halMillis();
+    hostMicros += SIM_COST_AUTO_MODE_US;
+    controller.runAutoMode(now);
+    unsigned long holdoff = controller.autoModeHoldoff(now);
+    return holdoff > 0 ? holdoff : SCHED_NEVER;
+}
+
+uint32_t publishTask(uint32_t) {
+    hostMicros += SIM_COST_PUBLISH_US + costJitter.spread(SIM_COST_PUBLISH_US / 2);
+    if (broadcastDeadband.due(controller.state, halMillis())) {
+        broadcastDeadband.sent(controller.state, halMillis());
+        stats.broadcasts++;
+    }
+    return SCHED_NEVER;
+}
+
+uint32_t wifiTask(uint32_t) {
+    hostMicros += SIM_COST_WIFI_US;
+    return WIFI_CHECK_INTERVAL;
+}
+
+// The serial console poll, a wake-up of its own in low power
+uint32_t consoleTask(uint32_t now) {
+    hostMicros += SIM_COST_CONSOLE_US;
+    return power.lowPower(now) ? CONSOLE_POLL_INTERVAL_LOW : CONSOLE_POLL_INTERVAL;
+}
+
+// POST /api/control pump=true about every manualInterval, at a random phase
+// against the measurement cycle; skipped while the pump is cooling down
+uint32_t manualTask(uint32_t) {
+    const SystemState &s = controller.state;
+    unsigned long now = halMillis();
+    power.activity(now);
+    if (!s.pumpActive && !s.sensorError && now - s.lastPumpCycle >= PUMP_COOLDOWN) {
+        manualPress = true;
+        controller.startPump();
+        manualPress = false;
+    }
+    return manualInterval + costJitter.spread(manualInterval / 4);
+}
+
+int main(int argc, char **argv) {
+    double days = argc > 1 ? atof(argv[1]) : 30;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1;
+    const char *profileName = argc > 3 ? argv[3] : "full";
+    manualInterval = argc > 4 ? (unsigned long)(atof(argv[4]) * 3600000.0) : 0;
+    uint8_t profile = !strcmp(profileName, "light") ? POWER_LIGHT_SLEEP :
+                      !strcmp(profileName, "modem") ? POWER_MODEM_SLEEP : POWER_FULL;
+
+    SoilSim soil(seed);
+    sim = &soil;
+
+    controller.begin();
+    scheduler.add("pump_timeout", pumpTimeoutTask, 500, true);
+    scheduler.add("sensors", sensorTask, 6000);
+    scheduler.add("auto_mode", autoModeTask, 2000);
+    scheduler.add("publish", publishTask, 10000);
+    scheduler.add("wifi", wifiTask, 1000);
+    scheduler.add("console", consoleTask, 20000);
+    scheduler.add("manual", manualTask, 1000);
+    scheduler.begin(halMillis());
+    for (uint8_t id = TASK_SENSORS; id < TASK_MANUAL; id++) {
+        scheduler.wake(id, halMillis());
+    }
+    if (manualInterval > 0) {
+        scheduler.wake(TASK_MANUAL, halMillis(), manualInterval);
+    }
+    power.begin(profile);
+
+    uint64_t end = (uint64_t)(days * 86400.0 * 1e6);
+    auto wallStart = std::chrono::steady_clock::now();
+
+    while (hostMicros < end) {
+        uint32_t now = halMillis();
+        scheduler.run(now);
+
+        // Sleep (low power) or spin (full power) to the next deadline; a
+        // pass that overran it runs again at once
+        unsigned long after = halMillis();
+        unsigned long deadline = after + (uint32_t)(scheduler.nextDeadline(after) - (uint32_t)after);
+        power.idle(after, deadline);
+        if (halMillis() < deadline) {
+            hostMicros = (uint64_t)deadline * 1000;
+        } else if (halMillis() == now) {
+            hostMicros += 1000 - hostMicros % 1000;
+        }
+    }
+    syncPhysics();
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double simulated = hostMicros / 1e6;
+
+    printf("Simulated %.1f days in %.2f s (%.0fx real time), seed %llu\n",
+           simulated / 86400, wall, simulated / wall, (unsigned long long)seed);
+    printf("Measurements: %lu (%.1f%% of fixed-rate), sensor errors: %lu\n", stats.measurements,
+           100.0 * stats.measurements / (simulated * 1000 / MEASUREMENT_INTERVAL), stats.sensorErrors);
+    printf("Sensor frames broadcast: %lu (%.1f%% of fixed-rate)\n", stats.broadcasts,
+           100.0 * stats.broadcasts / (simulated * 1000 / MEASUREMENT_INTERVAL));
+    printf("Pump cycles: %lu (%.1f/day, %lu from auto mode), water: %.1f l\n", stats.pumpCycles,
+           stats.pumpCycles * 86400 / simulated, stats.autoStarts, soil.waterUsed() / 1000);
+    printf("Longest run: %lu ms, shortest rest: %lu ms\n", stats.longestRun,
+           stats.pumpCycles > 1 ? stats.shortestRest : 0);
+    printf("Worst pump stop latency: %lu ms past the timeout (limit %d)\n",
+           stats.maxStopLatency, SIM_MAX_STOP_LATENCY);
+    printf("Scheduler: %lu passes, longest pass %.1f ms\n",
+           (unsigned long)scheduler.passes(), scheduler.maxPassMicros() / 1000.0);
+    for (uint8_t id = 0; id < scheduler.count(); id++) {
+        char line[112];
+        scheduler.formatSummary(id, line, sizeof(line));
+        printf("  %s", line);
+    }
+    printf("Moisture: %.1f..%.1f %%, below %d %% for %.2f %% of the time, saturated %.2f %%\n",
+           stats.moistureMin, stats.moistureMax, MOISTURE_THRESHOLD_LOW,
+           100 * stats.secondsDry / simulated, 100 * stats.secondsSaturated / simulated);
+    static const char *const states[POWER_STATE_COUNT] = {"active", "modem sleep", "light sleep"};
+    printf("Power profile %s: ~%.2f mA average (", profileName, power.averageMicroamps() / 1000.0);
+    for (uint8_t s = 0; s < POWER_STATE_COUNT; s++) {
+        printf("%s%s %.1f%%", s ? ", " : "", states[s], 100 * power.stateMicros(s) / 1e6 / simulated);
+    }
+    printf("), %lu sleeps\n", (unsigned long)power.sleeps());
+    printf("Violations: %lu\n", stats.violations);
+
+    if (manualInterval == 0 && simulated >= SIM_AUTO_CHECK_DAYS * 86400.0 && stats.autoStarts == 0) {
+        printf("FAIL: auto mode never started the pump\n");
+        return 1;
+    }
+    return stats.violations > 0 ? 1 : 0;
+}
\ No newline at end of file
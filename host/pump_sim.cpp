@@ -0,0 +1,222 @@
+// Compares auto mode pump control on the soil/pump simulator: runs that end
+// at the measured high threshold against runs that end on the moisture the
+// zone will settle at (PlantController::predictStop), same soil and seed.
+//
+// Usage: pump_sim [days] [seed] [pot ml]
+// The default pot is small for the pump (10 s of pumping is 50 %), so a run
+// can pass the high threshold inside PUMP_TIMEOUT. For each mode it prints
+// pump cycles, water pumped and drained below the roots, and the settling
+// error: the true moisture each automatic run peaks at once the water has
+// soaked in, against the high threshold. The last columns are readings per
+// day and how far off the dry forecast was: the first forecast under
+// PUMP_SIM_FORECAST_AHEAD after each run, against the next automatic start.
+
+#include <stdio.h>
+#include <string.h>
+#include "controller.h"
+#include "scheduler.h"
+#include "soil_sim.h"
+
+#define SIM_STEP_US 1000000ULL
+#define SIM_SYNC_US 100000ULL
+#define PUMP_SIM_POT_WATER 300.0    // ml per 100 % moisture
+#define PUMP_SIM_START 45.0         // % moisture at the start
+#define PUMP_SIM_SETTLE_WINDOW 3600 // s after a stop to look for the peak
+#define PUMP_SIM_FORECAST_AHEAD 21600000UL // ms; forecasts this close to dry are checked
+
+uint64_t hostMicros = 0;
+
+static SoilSim *sim;
+static uint64_t physicsMicros = 0;
+static bool relayOn = false;
+static PlantController controller;
+static Scheduler scheduler;
+
+enum TaskId : uint8_t {
+    TASK_PUMP_TIMEOUT,
+    TASK_SENSORS,
+    TASK_AUTO_MODE
+};
+
+struct PumpStats {
+    unsigned long cycles = 0;
+    unsigned long settled = 0;      // runs whose peak was measured
+    double errorSum = 0;            // % above (+) or below (-) the high threshold
+    double errorAbsSum = 0;
+    double errorMax = 0;
+    double secondsDry = 0;          // true moisture below MOISTURE_THRESHOLD_LOW
+    bool watching = false;          // looking for the peak after a stop
+    double peak = 0;
+    double stoppedAt = 0;           // s
+    unsigned long readings = 0;
+    unsigned long forecasts = 0;    // forecasts checked against a start
+    double forecastErrorSum = 0;    // h the start came after (+) or before (-) it
+    double forecastErrorAbsSum = 0;
+    unsigned long predictedStart = 0; // ms, 0 = no forecast pending
+};
+
+static PumpStats stats;
+
+// Counts the peak a stopped run soaked in to
+static void settle() {
+    if (!stats.watching) {
+        return;
+    }
+    double error = stats.peak - MOISTURE_THRESHOLD_HIGH;
+    stats.settled++;
+    stats.errorSum += error;
+    stats.errorAbsSum += fabs(error);
+    if (error > stats.errorMax) {
+        stats.errorMax = error;
+    }
+    stats.watching = false;
+}
+
+static void syncPhysics() {
+    while (physicsMicros < hostMicros) {
+        uint64_t step = hostMicros - physicsMicros;
+        if (step > SIM_STEP_US) {
+            step = SIM_STEP_US;
+        }
+        double dt = step / 1e6;
+        sim->step(physicsMicros / 1e6, dt, relayOn);
+        physicsMicros += step;
+
+        double moisture = sim->moisture();
+        if (moisture < MOISTURE_THRESHOLD_LOW) stats.secondsDry += dt;
+        if (stats.watching) {
+            if (moisture > stats.peak) stats.peak = moisture;
+            if (physicsMicros / 1e6 - stats.stoppedAt >= PUMP_SIM_SETTLE_WINDOW) settle();
+        }
+    }
+}
+
+int simAnalogRead(uint8_t pin) {
+    if (hostMicros - physicsMicros >= SIM_SYNC_US) {
+        syncPhysics();
+    }
+    return pin == SOIL_MOISTURE_PIN ? sim->adc(ADC_MAX) : 0;
+}
+
+void simDigitalWrite(uint8_t pin, uint8_t level) {
+    if (pin == PUMP_RELAY_PIN) {
+        syncPhysics();
+        relayOn = level == (RELAY_ACTIVE_LOW ? LOW : HIGH);
+    }
+}
+
+bool simReadDht(float &temperature, float &humidity) {
+    return sim->dht(temperature, humidity);
+}
+
+void onPumpChanged(bool active) {
+    unsigned long now = halMillis();
+    if (active) {
+        settle();
+        stats.cycles++;
+        if (stats.predictedStart) {
+            double error = ((long)(now - stats.predictedStart)) / 3600000.0;
+            stats.forecasts++;
+            stats.forecastErrorSum += error;
+            stats.forecastErrorAbsSum += fabs(error);
+            stats.predictedStart = 0;
+        }
+        scheduler.wakeAt(TASK_PUMP_TIMEOUT, controller.pumpDeadline());
+        scheduler.wake(TASK_SENSORS, now);
+    } else {
+        stats.watching = true;
+        stats.peak = sim->moisture();
+        stats.stoppedAt = hostMicros / 1e6;
+        scheduler.cancel(TASK_PUMP_TIMEOUT);
+        scheduler.wake(TASK_AUTO_MODE, now, controller.config.pumpCooldown);
+    }
+}
+
+uint32_t pumpTimeoutTask(uint32_t) {
+    controller.checkPumpTimeout(halMillis());
+    return controller.state.pumpActive ? 1 : SCHED_NEVER;
+}
+
+uint32_t sensorTask(uint32_t now) {
+    controller.startMeasurement(halMillis());
+    if (controller.updateSensorReadings(halMillis())) {
+        stats.readings++;
+        unsigned long dry = controller.dryIn(0);
+        if (!stats.predictedStart && !controller.state.pumpActive &&
+            !controller.response(0).soaking() && dry > 0 &&
+            dry <= PUMP_SIM_FORECAST_AHEAD) {
+            stats.predictedStart = halMillis() + dry;
+        }
+        scheduler.wake(TASK_AUTO_MODE, now);
+    }
+    return controller.nextStep(halMillis());
+}
+
+uint32_t autoModeTask(uint32_t) {
+    unsigned long now = halMillis();
+    controller.runAutoMode(now);
+    unsigned long holdoff = controller.autoModeHoldoff(now);
+    return holdoff > 0 ? holdoff : SCHED_NEVER;
+}
+
+static void simulate(bool predict, double days, uint64_t seed, double potWater) {
+    SoilSim soil(seed, PUMP_SIM_START, potWater);
+    sim = &soil;
+    hostMicros = 0;
+    physicsMicros = 0;
+    relayOn = false;
+    stats = PumpStats();
+    controller = PlantController();
+    scheduler = Scheduler();
+
+    controller.begin();
+    controller.predictStop = predict;
+    scheduler.add("pump_timeout", pumpTimeoutTask, 500, true);
+    scheduler.add("sensors", sensorTask, 6000);
+    scheduler.add("auto_mode", autoModeTask, 2000);
+    scheduler.begin(halMillis());
+    scheduler.wake(TASK_SENSORS, halMillis());
+
+    uint64_t end = (uint64_t)(days * 86400.0 * 1e6);
+    while (hostMicros < end) {
+        uint32_t now = halMillis();
+        scheduler.run(now);
+        unsigned long after = halMillis();
+        unsigned long deadline = after + (uint32_t)(scheduler.nextDeadline(after) - (uint32_t)after);
+        if (after < deadline) {
+            hostMicros = (uint64_t)deadline * 1000;
+        } else if (after == now) {
+            hostMicros += 1000 - hostMicros % 1000;
+        }
+    }
+    syncPhysics();
+    settle();
+
+    double simulated = hostMicros / 1e6;
+    printf("%-9s %7lu %8.2f %8.2f %+9.1f %9.1f %9.1f %9.2f %8.0f %+8.2f %8.2f",
+           predict ? "predict" : "threshold", stats.cycles, soil.waterUsed() / 1000,
+           soil.waterDrained() / 1000, stats.settled ? stats.errorSum / stats.settled : 0.0,
+           stats.settled ? stats.errorAbsSum / stats.settled : 0.0, stats.errorMax,
+           100 * stats.secondsDry / simulated, stats.readings * 86400 / simulated,
+           stats.forecasts ? stats.forecastErrorSum / stats.forecasts : 0.0,
+           stats.forecasts ? stats.forecastErrorAbsSum / stats.forecasts : 0.0);
+    if (predict) {
+        const ZoneResponse &response = controller.response(0);
+        printf("   slope %.2f %%/s, lag %.0f s", response.slope() / 100.0, response.lag() / 1000.0);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    double days = argc > 1 ? atof(argv[1]) : 30;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1;
+    double potWater = argc > 3 ? atof(argv[3]) : PUMP_SIM_POT_WATER;
+
+    printf("%.1f days, seed %llu, %.0f ml pot, high threshold %d %%\n", days,
+           (unsigned long long)seed, potWater, MOISTURE_THRESHOLD_HIGH);
+    printf("%-9s %7s %8s %8s %9s %9s %9s %9s %8s %8s %8s\n", "stop on", "cycles", "water l",
+           "drain l", "settle %", "|err| %", "max %", "dry %", "reads/d", "fcst h", "|fcst| h");
+    simulate(false, days, seed, potWater);
+    simulate(true, days, seed, potWater);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#ifndef SOIL_SIM_H
+#define SOIL_SIM_H
+
+#include <math.h>
+#include <stdint.h>
+
+// Lumped model of one pot with a probe, a pump and a DHT sensor.
+//
+// Soil moisture is kept as the percentage the probe would report. The pump
+// fills a surface pool which soaks in with a time constant, so moisture keeps
+// rising for a while after the pump stops. Evaporation scales with air
+// temperature, vapour pressure deficit and soil moisture; water above field
+// capacity drains away. Temperature and humidity follow a daily cycle.
+
+#define SIM_PUMP_FLOW 15.0          // ml/s
+#define SIM_POT_WATER 1500.0        // ml of water per 100 % moisture
+#define SIM_INFILTRATION_TAU 120.0  // s for surface water to soak in (1/e)
+#define SIM_FIELD_CAPACITY 85.0     // % moisture, drains above this
+#define SIM_DRAIN_TAU 600.0         // s
+#define SIM_ET_RATE 0.0012          // %/s at 20 C, 0 %RH, 100 % moisture
+#define SIM_ADC_NOISE 4             // peak ADC counts
+#define SIM_DHT_FAIL_PPM 3000       // failed DHT transfers per million
+
+// Small deterministic PRNG so runs are reproducible from the seed
+struct SimRandom {
+    uint64_t state;
+
+    explicit SimRandom(uint64_t seed) : state(seed * 2654435761u + 1) {}
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state >> 32;
+    }
+
+    // Uniform in [-range, range]
+    int spread(int range) {
+        return (int)(next() % (2 * range + 1)) - range;
+    }
+};
+
+class SoilSim {
+public:
+    explicit SoilSim(uint64_t seed, double moisture = 55.0, double potWater = SIM_POT_WATER)
+        : _random(seed), _moisture(moisture), _potWater(potWater) {}
+
+    // Advances the model by dt seconds; time is seconds since the start
+    void step(double time, double dt, bool pumpOn) {
+        updateAir(time);
+        if (pumpOn) {
+            _surface += SIM_PUMP_FLOW * dt;
+            _waterUsed += SIM_PUMP_FLOW * dt;
+        }
+
+        double soaked = _surface * (1.0 - exp(-dt / SIM_INFILTRATION_TAU));
+        _surface -= soaked;
+        _moisture += soaked * 100.0 / _potWater;
+
+        double vpd = 1.0 - _humidity / 100.0;
+        double warmth = exp(0.06 * (_temperature - 20.0));
+        _moisture -= SIM_ET_RATE * warmth * vpd * (_moisture / 100.0) * dt;
+
+        if (_moisture > SIM_FIELD_CAPACITY) {
+            double drained = (_moisture - SIM_FIELD_CAPACITY) * (1.0 - exp(-dt / SIM_DRAIN_TAU));
+            _moisture -= drained;
+            _waterDrained += drained * _potWater / 100.0;
+        }
+        if (_moisture > 100.0) {
+            _waterDrained += (_moisture - 100.0) * _potWater / 100.0;
+            _moisture = 100.0;
+        }
+    }
+
+    // Probe reading: inverse-linear in moisture, as the firmware assumes
+    int adc(int adcMax) {
+        int value = (int)lround(adcMax * (1.0 - _moisture / 100.0)) + _random.spread(SIM_ADC_NOISE);
+        return value < 0 ? 0 : (value > adcMax ? adcMax : value);
+    }
+
+    // DHT11 reading with whole-unit resolution; false for a failed transfer
+    bool dht(float &temperature, float &humidity) {
+        if (_random.next() % 1000000 < SIM_DHT_FAIL_PPM) {
+            return false;
+        }
+        temperature = (float)lround(_temperature);
+        humidity = (float)lround(_humidity);
+        return true;
+    }
+
+    double moisture() const { return _moisture; }
+    double temperature() const { return _temperature; }
+    double humidity() const { return _humidity; }
+    double waterUsed() const { return _waterUsed; }
+    double waterDrained() const { return _waterDrained; }  // ml lost below the roots
+
+private:
+    void updateAir(double time) {
+        // Warmest and driest mid-afternoon
+        double phase = 2.0 * M_PI * (time - 9.0 * 3600.0) / 86400.0;
+        _temperature = 22.0 + 6.0 * sin(phase);
+        _humidity = 55.0 - 20.0 * sin(phase);
+    }
+
+    SimRandom _random;
+    double _moisture;
+    double _potWater;   // ml per 100 % moisture
+    double _surface = 0;
+    double _temperature = 22.0;
+    double _humidity = 55.0;
+    double _waterUsed = 0;
+    double _waterDrained = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdint.h>
+#include "config.h"
+#include "types.h"
+
+enum CalibrationState : uint8_t {
+    CAL_IDLE,       // No session
+    CAL_READY,      // Session open, waiting for a capture
+    CAL_CAPTURING   // Averaging readings for a point
+};
+
+// Field calibration of one probe, driven from /api/calibrate: open a
+// session for a probe, put it in dry soil, wet soil and anything between,
+// capturing a point at each. A capture averages CAL_CAPTURE_SAMPLES raw ADC
+// samples that the controller feeds in as it scans, so nothing blocks.
+// curve() returns the points sorted for PlantController::setCalibration().
+class CalibrationWizard {
+public:
+    bool start(uint8_t probe) {
+        if (probe >= SOIL_PROBE_COUNT) {
+            return false;
+        }
+        _probe = probe;
+        _count = 0;
+        _state = CAL_READY;
+        return true;
+    }
+
+    // Starts averaging readings for a point at moisture (0.1 %). A second
+    // capture at the same moisture replaces the first.
+    bool capture(int16_t moisture) {
+        if (_state != CAL_READY || moisture < 0 || moisture > 1000) {
+            return false;
+        }
+        _slot = _count;
+        for (uint8_t i = 0; i < _count; i++) {
+            if (_points[i].moisture == moisture) {
+                _slot = i;
+            }
+        }
+        if (_slot >= CAL_POINTS_MAX) {
+            return false;
+        }
+        _target = moisture;
+        _sum = 0;
+        _samples = 0;
+        _state = CAL_CAPTURING;
+        return true;
+    }
+
+    // Every raw ADC sample of every probe, from the controller's scan
+    void sample(uint8_t probe, uint16_t raw) {
+        if (_state != CAL_CAPTURING || probe != _probe) {
+            return;
+        }
+        _sum += raw;
+        if (++_samples < CAL_CAPTURE_SAMPLES) {
+            return;
+        }
+        _points[_slot].raw = (_sum + CAL_CAPTURE_SAMPLES / 2) / CAL_CAPTURE_SAMPLES;
+        _points[_slot].moisture = _target;
+        if (_slot == _count) {
+            _count++;
+        }
+        _state = CAL_READY;
+    }
+
+    // The captured points sorted by counts; false unless there are at
+    // least two and no two share a count
+    bool curve(CalPoint *points, uint8_t &count) const {
+        if (_state != CAL_READY || _count < 2) {
+            return false;
+        }
+        for (uint8_t i = 0; i < _count; i++) {
+            CalPoint p = _points[i];
+            uint8_t j = i;
+            for (; j > 0 && points[j - 1].raw > p.raw; j--) {
+                points[j] = points[j - 1];
+            }
+            points[j] = p;
+        }
+        for (uint8_t i = 1; i < _count; i++) {
+            if (points[i].raw == points[i - 1].raw) {
+                return false;
+            }
+        }
+        count = _count;
+        return true;
+    }
+
+    void cancel() { _state = CAL_IDLE; }
+
+    CalibrationState state() const { return _state; }
+    bool capturing() const { return _state == CAL_CAPTURING; }
+    uint8_t probe() const { return _probe; }
+    uint8_t count() const { return _count; }
+    const CalPoint &point(uint8_t i) const { return _points[i]; }
+    uint16_t samples() const { return _samples; }
+
+private:
+    CalibrationState _state = CAL_IDLE;
+    uint8_t _probe = 0;
+    uint8_t _count = 0;
+    uint8_t _slot = 0;
+    int16_t _target = 0;
+    uint16_t _samples = 0;
+    uint32_t _sum = 0;
+    CalPoint _points[CAL_POINTS_MAX] = {};
+};
+
+#ifdef ARDUINO
+#include <LittleFS.h>
+
+// Saved curves: a header, then ProbeCalibration as stored in RAM. A file
+// written for another probe count or point limit is ignored.
+#define CAL_FILE "/calibration.bin"
+#define CAL_FILE_MAGIC 0x4C414350UL  // "PCAL"
+#define CAL_FILE_VERSION 1
+
+struct CalFileHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t probes;
+    uint8_t pointsMax;
+    uint8_t reserved;
+};
+
+inline bool saveCalibration(const ProbeCalibration &calibration) {
+    CalFileHeader header = {CAL_FILE_MAGIC, CAL_FILE_VERSION, SOIL_PROBE_COUNT, CAL_POINTS_MAX, 0};
+    File f = LittleFS.open(CAL_FILE, "w");
+    if (!f) {
+        return false;
+    }
+    bool ok = f.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              f.write((const uint8_t *)&calibration, sizeof(calibration)) == sizeof(calibration);
+    f.close();
+    return ok;
+}
+
+inline bool loadCalibration(ProbeCalibration &calibration) {
+    File f = LittleFS.open(CAL_FILE, "r");
+    if (!f) {
+        return false;
+    }
+    CalFileHeader header;
+    bool ok = f.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == CAL_FILE_MAGIC && header.version == CAL_FILE_VERSION &&
+              header.probes == SOIL_PROBE_COUNT && header.pointsMax == CAL_POINTS_MAX &&
+              f.read((uint8_t *)&calibration, sizeof(calibration)) == sizeof(calibration);
+    f.close();
+    return ok;
+}
+#endif
+
+#endif
\ No newline at end of file
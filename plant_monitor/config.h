@@ -11,34 +11,139 @@
 // Pin Definitions
 #define DHT_PIN D4          // GPIO2
 #define DHT_TYPE DHT11      // Using DHT11
+#define DHT_MIN_INTERVAL 2000  // ms between physical DHT reads; sooner ones reuse the last
 #define SOIL_MOISTURE_PIN A0 // Analog pin
 #define PUMP_RELAY_PIN D1   // GPIO5
 
-// NodeMCU ADC Calibration (0-1V input)
-// These values need to be adjusted based on your sensor's voltage output
-// For 3.3V sensor through voltage divider
+// Soil probes: 1 reads a single probe on SOIL_MOISTURE_PIN; 2-16 puts a
+// CD74HC4067-style analog mux in front of it, channel selected on S0-S3
+#define SOIL_PROBE_COUNT 1
+#define MUX_S0_PIN D5       // GPIO14
+#define MUX_S1_PIN D6       // GPIO12
+#define MUX_S2_PIN D7       // GPIO13
+#define MUX_S3_PIN D0       // GPIO16
+#define MUX_SETTLE_MS 2     // ms after a channel switch before the ADC read
+
+// Irrigation zones: 1 waters through the pump alone; 2-16 adds a valve per
+// zone on a 74HC595 shift register chain, zone N watered by probe N. One
+// zone runs at a time.
+#define ZONE_COUNT 1
+#define VALVE_DATA_PIN D3   // GPIO0
+#define VALVE_CLOCK_PIN D8  // GPIO15
+#define VALVE_LATCH_PIN D2  // GPIO4
+
+// NodeMCU ADC (0-1V input, 3.3V sensor through a voltage divider). Moisture
+// comes from the calibration curve below; the voltage is only logged.
 #define ADC_MAX 1023        // 10-bit ADC
 #define VOLTAGE_MAX 1.0     // NodeMCU can only read up to 1V
 #define SENSOR_VOLTAGE 3.3  // Original sensor voltage
 
+// Probe response as (ADC counts, moisture in 0.1 %) points sorted by counts.
+// The ADC-to-moisture lookup table is generated from these at compile time
+// and kept in flash. Capacitive probes are not linear: measure a few points
+// across the range, e.g. {{310, 1000}, {450, 800}, {560, 500}, {700, 200}, {850, 0}}
+#define SOIL_CAL_POINTS {{0, 1000}, {ADC_MAX, 0}}
+// Per-probe curves captured with /api/calibrate replace it and are kept
+// in flash; each captured point averages this many ADC samples
+#define CAL_CAPTURE_SAMPLES 64
+
 // Soil Moisture Calibration
 // These are percentage thresholds
 #define MOISTURE_THRESHOLD_LOW 30    // 30% threshold for dry soil
 #define MOISTURE_THRESHOLD_HIGH 70   // 70% threshold for wet soil
 
+// Soak test build: 1 speeds up measurements and prints a heap line every
+// HEAP_SAMPLE_INTERVAL, for use with tools/heap_soak.py
+#define HEAP_SOAK 0
+
 // System Parameters
-#define MEASUREMENT_INTERVAL 1000    // 1 second between readings
+// Sampling adapts between MEASUREMENT_INTERVAL (pump running or moisture
+// moving) and MEASUREMENT_INTERVAL_MAX (readings stable), or up to
+// FORECAST_INTERVAL_MAX while a dry forecast allows it; sensor frames go
+// out when a value leaves its deadband or the heartbeat is due
+#if HEAP_SOAK
+#define MEASUREMENT_INTERVAL 100     // Soak test: 10x the sensor/SSE traffic
+#define MEASUREMENT_INTERVAL_MAX 100
+#define FORECAST_INTERVAL_MAX 100
+#define SSE_HEARTBEAT_INTERVAL 0     // every reading
+#else
+#define MEASUREMENT_INTERVAL 1000    // 1 second between readings at the fastest
+#define MEASUREMENT_INTERVAL_MAX 30000
+#define FORECAST_INTERVAL_MAX 300000 // Steady readings with no dashboard connected; see LOG_FLUSH_AGE
+#define SSE_HEARTBEAT_INTERVAL 60000 // Longest time without a sensor frame
+#endif
+#define MOISTURE_STABLE_BAND 0.5     // % change between readings that still counts as stable
+#define SSE_DEADBAND_MOISTURE 1.0    // % moisture
+#define SSE_DEADBAND_TEMPERATURE 0.5 // C
+#define SSE_DEADBAND_HUMIDITY 2.0    // %RH
 #define PUMP_TIMEOUT 10000          // 10 seconds max pump runtime
 #define PUMP_COOLDOWN 5000         // 5 seconds cooldown
+#define MAX_PUMP_CYCLES 6          // Pump starts per hour before auto mode holds off
+// 1: auto mode learns each zone's response to watering (zone_response.h)
+// and ends a run once the moisture it will settle at reaches the high
+// threshold. 0: runs end when the measured moisture gets there.
+#define PUMP_PREDICT 1
+#define RESPONSE_SETTLE_MS 60000   // a run has soaked in once moisture stops rising this long
+// 1: each zone learns how fast it dries for the air's temperature and
+// humidity (dry_forecast.h). Steady readings are then spaced out towards
+// the time it is forecast to reach its low threshold, FORECAST_SAMPLES
+// readings before it at the least. 0: steady readings every
+// MEASUREMENT_INTERVAL_MAX.
+#define DRY_FORECAST 1
+#define FORECAST_SAMPLES 8
 #define RELAY_ACTIVE_LOW true      // Set to true if relay triggers on LOW
 #define WIFI_CHECK_INTERVAL 1000   // Check WiFi every second
+#define SCHED_PASS_BUDGET 5000     // us per loop() pass before lower-priority tasks wait
+#define CONSOLE_POLL_INTERVAL 100  // ms between serial console checks
+#define CONSOLE_POLL_INTERVAL_LOW 1000 // ms between them while in a low-power profile
+#define SOIL_SAMPLE_COUNT 5        // ADC samples filtered per probe and measurement
+#define SOIL_SAMPLE_SPACING 10     // ms between ADC samples (taken across loop passes)
+                                   // with the mux, MUX_SETTLE_MS between channels instead
+// Soil ADC filter stages (filters.h), applied per probe to every sample:
+// median window, EMA factor 1/2^shift, Kalman noise variances in 1/16 count^2
+#define SOIL_FILTER_MEDIAN 5       // 1 turns the stage off
+#define SOIL_FILTER_EMA_SHIFT 1    // 0 turns the stage off
+#define SOIL_FILTER_KALMAN_Q 0
+#define SOIL_FILTER_KALMAN_R 0     // 0 turns the stage off
+
+// Power management: 0 full power, 1 modem sleep, 2 light sleep between
+// scheduled work. Full power is used while the pump runs and for
+// POWER_AWAKE_HOLD after an incoming connection; in low power, sensor
+// frames are batched for connected clients. Switch at runtime with
+// POST /api/control power=full|modem|light.
+#define POWER_PROFILE 0
+#define POWER_AWAKE_HOLD 60000     // ms at full power after a page load, SSE connect or control request
+#define POWER_MIN_IDLE 3           // ms; shorter gaps are not worth a sleep
+#define POWER_LISTEN_INTERVAL 3    // Light sleep: wake for every 3rd DTIM beacon
+#define POWER_BATCH_SIZE 8         // Sensor frames held back in low power
+#define POWER_BATCH_INTERVAL 60000 // Longest a frame is held back (ms)
+// Current draw per state for the average estimate, in uA (ESP8266EX
+// datasheet figures for the module alone; replace with measured values)
+#define POWER_CURRENT_ACTIVE_UA 80000
+#define POWER_CURRENT_MODEM_UA 15000
+#define POWER_CURRENT_LIGHT_UA 900
 
 // Memory Optimization
-#define JSON_BUFFER_SIZE 200
+#define JSON_BUFFER_SIZE (256 + 8 * SOIL_PROBE_COUNT + 8 * ZONE_COUNT)
+#define HISTORY_ROW_MAX 40         // Longest /api/history row
+#define EXPORT_ROW_MAX 96          // Longest /api/export row
+#define MAX_EXPORTS 2              // Concurrent /api/export streams
+#define SSE_MAX_BACKLOG 2          // Skip a sensor frame while clients have this many queued
 #define MAX_SENSOR_ERRORS 3
 
-// EEPROM Configuration
-#define EEPROM_SIZE 512
-#define CONFIG_START_ADDRESS 0
+// Diagnostics
+#define LOG_LEVEL 3                // Serial log compiled in: 1 error, 2 warn, 3 info, 4 debug
+#define LOG_RING_SIZE 1024         // Bytes of log text buffered for the UART
+#define LOOP_METRICS 1             // Per-stage loop() timing at /api/metrics, 0 compiles it out
+#define HEAP_METRICS 1             // Heap and fragmentation tracking at /api/metrics
+#define HEAP_SAMPLE_INTERVAL 1000  // ms between heap samples
+#define METRICS_LINE_MAX 112       // Longest /api/metrics line
+
+// Settings storage (config_store.h): thresholds, pump limits, auto mode and
+// power profile in two flash sectors. A change is written once settings
+// have been left alone for CONFIG_COMMIT_DELAY, at most once per
+// CONFIG_COMMIT_INTERVAL.
+#define CONFIG_COMMIT_DELAY 5000      // ms
+#define CONFIG_COMMIT_INTERVAL 30000  // ms
 
 #endif 
\ No newline at end of file
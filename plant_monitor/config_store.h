@@ -0,0 +1,279 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "config.h"
+#include "hal.h"
+#include "types.h"
+
+#define CONFIG_MAGIC 0x47464350UL  // "PCFG"
+#define CONFIG_VERSION 1           // Bump when StoredConfig changes; other versions are ignored
+
+// Settings kept across reboots
+struct StoredConfig {
+    SystemConfig limits;             // PlantController::config
+    SystemConfig zones[ZONE_COUNT];  // PlantController::zones
+    uint8_t autoMode;
+    uint8_t powerProfile;
+};
+
+// Parts of StoredConfig tracked for changes (bit n of ConfigStore::dirty())
+enum ConfigField : uint8_t {
+    CONFIG_FIELD_LIMITS,
+    CONFIG_FIELD_ZONES,
+    CONFIG_FIELD_AUTO_MODE,
+    CONFIG_FIELD_POWER,
+    CONFIG_FIELD_COUNT
+};
+
+// One saved copy of the settings. Each commit appends a record, so a sector
+// is only erased once it is full.
+struct ConfigRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;        // sizeof(StoredConfig)
+    uint32_t sequence;    // +1 per commit, the newest valid record wins
+    uint32_t erases[2];   // erases of each sector since it was first used
+    StoredConfig data;
+    uint32_t crc;         // CRC-32 of the record up to here
+};
+
+static_assert(sizeof(ConfigRecord) % 4 == 0, "flash is read and written in words");
+
+#define CONFIG_RECORD_SLOTS (HAL_FLASH_SECTOR_SIZE / sizeof(ConfigRecord))
+
+// CRC-32 (IEEE 802.3), four bits at a time from a 16-entry table
+inline uint32_t configCrc32(const void *data, size_t size) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFF;
+    while (size--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 15];
+        crc = (crc >> 4) ^ table[crc & 15];
+    }
+    return ~crc;
+}
+
+// Settings in two flash sectors (A/B). Records go into the active sector
+// one after another. When it is full the other sector is erased and
+// becomes active, so the newest record on flash stays intact while a new
+// one is written. A record only counts if its version, size and CRC match,
+// which makes a torn write or blank flash look like no record.
+//
+// update() compares the live settings with the last commit and marks the
+// fields that differ. A change is committed once the settings have been
+// left alone for CONFIG_COMMIT_DELAY, and no sooner than
+// CONFIG_COMMIT_INTERVAL after the previous commit.
+class ConfigStore {
+public:
+    // Reads each record of both sectors once, keeping the newest valid one.
+    // True with it in data; false leaves data (the defaults) as it is.
+    bool begin(StoredConfig &data) {
+        unsigned long start = halMicros();
+        memset(&_record, 0, sizeof(_record));
+        _ready = halConfigSectors(_firstSector);
+        _loaded = false;
+        for (uint8_t sector = 0; _ready && sector < 2; sector++) {
+            _next[sector] = 0;
+            ConfigRecord record;
+            while (_next[sector] < CONFIG_RECORD_SLOTS &&
+                   halFlashRead(address(sector, _next[sector]), (uint32_t *)&record, sizeof(record)) &&
+                   !blank(record)) {
+                _next[sector]++;
+                if (!valid(record)) {
+                    _rejected++;
+                } else if (!_loaded || (int32_t)(record.sequence - _record.sequence) > 0) {
+                    _record = record;
+                    _sector = sector;
+                    _loaded = true;
+                }
+            }
+        }
+        if (_loaded) {
+            memcpy(&data, &_record.data, sizeof(data));
+        }
+        memcpy(&_live, &data, sizeof(_live));
+        _dirty = 0;
+        _loadMicros = halMicros() - start;
+        return _loaded;
+    }
+
+    // The live settings; marks the fields that differ from the last commit
+    void update(const StoredConfig &live, unsigned long now) {
+        if (memcmp(&live, &_live, sizeof(live)) != 0) {
+            memcpy(&_live, &live, sizeof(_live));
+            _changedAt = now;
+        }
+        _dirty = 0;
+        for (uint8_t field = 0; field < CONFIG_FIELD_COUNT; field++) {
+            const uint8_t *a = (const uint8_t *)&_live + FIELD_OFFSET[field];
+            const uint8_t *b = (const uint8_t *)&_record.data + FIELD_OFFSET[field];
+            if (!_loaded || memcmp(a, b, FIELD_SIZE[field]) != 0) {
+                _dirty |= 1 << field;
+            }
+        }
+    }
+
+    // Milliseconds until the pending change may be committed (0 = now)
+    unsigned long commitDelay(unsigned long now) const {
+        unsigned long wait = 0;
+        if (now - _changedAt < CONFIG_COMMIT_DELAY) {
+            wait = CONFIG_COMMIT_DELAY - (now - _changedAt);
+        }
+        if (_attempted && now - _lastCommit < CONFIG_COMMIT_INTERVAL &&
+            CONFIG_COMMIT_INTERVAL - (now - _lastCommit) > wait) {
+            wait = CONFIG_COMMIT_INTERVAL - (now - _lastCommit);
+        }
+        return wait;
+    }
+
+    // Writes the live settings as a new record, erasing the other sector
+    // first when the active one is full. The record is read back before it
+    // counts as committed.
+    bool commit(unsigned long now) {
+        unsigned long start = halMicros();
+        _attempted = true;
+        _lastCommit = now;
+        if (!_ready) {
+            _failures++;
+            return false;
+        }
+        ConfigRecord record;
+        memset(&record, 0, sizeof(record));
+        record.magic = CONFIG_MAGIC;
+        record.version = CONFIG_VERSION;
+        record.size = sizeof(StoredConfig);
+        record.sequence = _record.sequence + 1;
+        record.erases[0] = _record.erases[0];
+        record.erases[1] = _record.erases[1];
+        memcpy(&record.data, &_live, sizeof(record.data));
+
+        // Active sector full: erase the other one. Nothing valid on flash
+        // yet: erase sector A rather than trust whatever it holds.
+        uint8_t sector = _sector;
+        if (_next[sector] >= CONFIG_RECORD_SLOTS || !_loaded) {
+            sector = _loaded ? sector ^ 1 : 0;
+            if (!halFlashErase(_firstSector + sector)) {
+                _failures++;
+                return false;
+            }
+            _next[sector] = 0;
+            record.erases[sector]++;
+            _record.erases[sector]++;
+        }
+        record.crc = configCrc32(&record, offsetof(ConfigRecord, crc));
+
+        uint32_t at = address(sector, _next[sector]++);
+        ConfigRecord check;
+        if (!halFlashWrite(at, (const uint32_t *)&record, sizeof(record)) ||
+            !halFlashRead(at, (uint32_t *)&check, sizeof(check)) ||
+            memcmp(&check, &record, sizeof(record)) != 0) {
+            _failures++;
+            return false;
+        }
+        _record = record;
+        _sector = sector;
+        _loaded = true;
+        _dirty = 0;
+        _commits++;
+        _lastMicros = halMicros() - start;
+        if (_lastMicros > _maxMicros) {
+            _maxMicros = _lastMicros;
+        }
+        return true;
+    }
+
+    bool ready() const { return _ready; }
+    bool loaded() const { return _loaded; }
+    uint8_t dirty() const { return _dirty; }
+    uint32_t sequence() const { return _record.sequence; }
+    uint32_t commits() const { return _commits; }
+    uint32_t failures() const { return _failures; }
+    uint32_t erases(uint8_t sector) const { return _record.erases[sector]; }
+    uint32_t rejected() const { return _rejected; }
+    unsigned long lastCommitMicros() const { return _lastMicros; }
+    unsigned long maxCommitMicros() const { return _maxMicros; }
+    unsigned long loadMicros() const { return _loadMicros; }
+
+    static constexpr uint16_t lineCount() { return 16; }
+
+    // Prometheus lines for /api/metrics; 0 past the end
+    size_t formatLine(uint16_t n, char *out, size_t size) const {
+        switch (n) {
+            case 0: return snprintf(out, size, "# TYPE config_commits_total counter\n");
+            case 1: return snprintf(out, size, "config_commits_total %lu\n", (unsigned long)_commits);
+            case 2: return snprintf(out, size, "# TYPE config_commit_failures_total counter\n");
+            case 3: return snprintf(out, size, "config_commit_failures_total %lu\n", (unsigned long)_failures);
+            case 4: return snprintf(out, size, "# TYPE config_flash_erases_total counter\n");
+            case 5:
+            case 6: return snprintf(out, size, "config_flash_erases_total{sector=\"%u\"} %lu\n",
+                                    n - 5, (unsigned long)_record.erases[n - 5]);
+            case 7: return snprintf(out, size, "# TYPE config_commit_seconds gauge\n");
+            case 8: return snprintf(out, size, "config_commit_seconds{stat=\"last\"} %.6f\n", _lastMicros * 1e-6);
+            case 9: return snprintf(out, size, "config_commit_seconds{stat=\"max\"} %.6f\n", _maxMicros * 1e-6);
+            case 10: return snprintf(out, size, "# TYPE config_load_seconds gauge\n");
+            case 11: return snprintf(out, size, "config_load_seconds %.6f\n", _loadMicros * 1e-6);
+            case 12: return snprintf(out, size, "# TYPE config_dirty_fields gauge\n");
+            case 13: return snprintf(out, size, "config_dirty_fields %u\n", _dirty);
+            case 14: return snprintf(out, size, "# TYPE config_rejected_records gauge\n");
+            case 15: return snprintf(out, size, "config_rejected_records %lu\n", (unsigned long)_rejected);
+            default: return 0;
+        }
+    }
+
+private:
+    static constexpr size_t FIELD_OFFSET[CONFIG_FIELD_COUNT] = {
+        offsetof(StoredConfig, limits), offsetof(StoredConfig, zones),
+        offsetof(StoredConfig, autoMode), offsetof(StoredConfig, powerProfile)
+    };
+    static constexpr size_t FIELD_SIZE[CONFIG_FIELD_COUNT] = {
+        sizeof(SystemConfig), sizeof(SystemConfig) * ZONE_COUNT, sizeof(uint8_t), sizeof(uint8_t)
+    };
+
+    uint32_t address(uint8_t sector, uint16_t slot) const {
+        return (_firstSector + sector) * HAL_FLASH_SECTOR_SIZE + slot * sizeof(ConfigRecord);
+    }
+
+    static bool blank(const ConfigRecord &record) {
+        const uint32_t *words = (const uint32_t *)&record;
+        for (size_t i = 0; i < sizeof(record) / 4; i++) {
+            if (words[i] != 0xFFFFFFFF) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool valid(const ConfigRecord &record) {
+        return record.magic == CONFIG_MAGIC && record.version == CONFIG_VERSION &&
+               record.size == sizeof(StoredConfig) &&
+               record.crc == configCrc32(&record, offsetof(ConfigRecord, crc));
+    }
+
+    bool _ready = false;
+    bool _loaded = false;
+    bool _attempted = false;
+    uint32_t _firstSector = 0;
+    uint8_t _sector = 0;                 // holds the newest record
+    uint16_t _next[2] = {};              // first unused slot of each sector
+    ConfigRecord _record = {};           // last committed (or loaded) record
+    StoredConfig _live = {};
+    uint8_t _dirty = 0;
+    unsigned long _changedAt = 0;
+    unsigned long _lastCommit = 0;
+    uint32_t _commits = 0;
+    uint32_t _failures = 0;
+    uint32_t _rejected = 0;
+    unsigned long _lastMicros = 0;
+    unsigned long _maxMicros = 0;
+    unsigned long _loadMicros = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,537 @@
+#ifndef CONTROLLER_H
+#define CONTROLLER_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal.h"
+#include "calibration.h"
+#include "config.h"
+#include "dry_forecast.h"
+#include "filters.h"
+#include "moisture_lut.h"
+#include "types.h"
+#include "zone_response.h"
+
+static_assert(SOIL_PROBE_COUNT >= 1 && SOIL_PROBE_COUNT <= 16,
+              "SOIL_PROBE_COUNT must be 1-16 (one 16-channel mux)");
+static_assert(ZONE_COUNT >= 1 && ZONE_COUNT <= SOIL_PROBE_COUNT,
+              "each irrigation zone needs its own soil probe");
+
+#define PUMP_CYCLE_WINDOW 3600000UL  // ms over which config.maxPumpCycles applies
+
+// Time between ADC reads; with the mux each read is on a freshly selected
+// channel, so the spacing is the settling time
+#define SOIL_STEP_SPACING (SOIL_PROBE_COUNT > 1 ? MUX_SETTLE_MS : SOIL_SAMPLE_SPACING)
+static_assert(SOIL_PROBE_COUNT * SOIL_SAMPLE_COUNT * SOIL_STEP_SPACING < MEASUREMENT_INTERVAL,
+              "soil scan does not fit in MEASUREMENT_INTERVAL");
+
+// Built-in ADC-to-moisture table for probes without a runtime curve
+static constexpr CalPoint SOIL_CAL_CURVE[] = SOIL_CAL_POINTS;
+static constexpr MoistureTable SOIL_MOISTURE_TABLE PROGMEM =
+    buildMoistureTable(SOIL_CAL_CURVE, sizeof(SOIL_CAL_CURVE) / sizeof(SOIL_CAL_CURVE[0]));
+
+// Called on every pump start/stop; defined by the sketch (SSE, log) and by
+// the host simulator
+void onPumpChanged(bool active);
+
+// Sensor acquisition and pump control, shared by the firmware and the host
+// build. Everything hardware-facing goes through hal.h.
+class PlantController {
+public:
+    PlantController() : _dht(DHT_PIN, DHT_TYPE) {}
+
+    SystemState state = {};
+    ProbeCalibration calibration = {};
+    SystemConfig config = {};            // shared by all zones: cooldown, starts per hour
+    SystemConfig zones[ZONE_COUNT] = {}; // per zone: autoMode, thresholds, run length
+    CalibrationWizard wizard;            // fed every raw ADC sample while a capture runs
+    bool predictStop = PUMP_PREDICT;     // end auto runs on the predicted moisture
+    bool forecastSampling = DRY_FORECAST; // space steady readings out by the dry forecast
+
+    void begin() {
+        halPinMode(PUMP_RELAY_PIN, OUTPUT);
+        halDigitalWrite(PUMP_RELAY_PIN, RELAY_ACTIVE_LOW ? HIGH : LOW); // Ensure pump is off
+        if (SOIL_PROBE_COUNT > 1) {
+            halPinMode(MUX_S0_PIN, OUTPUT);
+            halPinMode(MUX_S1_PIN, OUTPUT);
+            halPinMode(MUX_S2_PIN, OUTPUT);
+            halPinMode(MUX_S3_PIN, OUTPUT);
+            selectProbe(0);
+        }
+        if (ZONE_COUNT > 1) {
+            halPinMode(VALVE_DATA_PIN, OUTPUT);
+            halPinMode(VALVE_CLOCK_PIN, OUTPUT);
+            halPinMode(VALVE_LATCH_PIN, OUTPUT);
+            writeValves(-1);
+        }
+        config.autoMode = true;
+        config.moistureThresholdLow = MOISTURE_THRESHOLD_LOW;
+        config.moistureThresholdHigh = MOISTURE_THRESHOLD_HIGH;
+        config.maxPumpCycles = MAX_PUMP_CYCLES;
+        config.pumpTimeout = PUMP_TIMEOUT;
+        config.pumpCooldown = PUMP_COOLDOWN;
+        for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+            zones[i] = config;
+        }
+        state.activeZone = -1;
+        for (uint8_t i = 0; i < SOIL_PROBE_COUNT; i++) {
+            calibration.count[i] = 0;
+            _curves[i].useTable(&SOIL_MOISTURE_TABLE);
+        }
+        FilterConfig filter = {SOIL_FILTER_MEDIAN, SOIL_FILTER_EMA_SHIFT,
+                               SOIL_FILTER_KALMAN_Q, SOIL_FILTER_KALMAN_R};
+        configureFilters(filter);
+        _dht.init();
+        state.autoMode = true;
+        state.measurementInterval = MEASUREMENT_INTERVAL;
+    }
+
+    // Starts a new measurement cycle once the sampling interval has passed
+    void startMeasurement(unsigned long now) {
+        if (_samplerState == SAMPLER_IDLE && now - state.lastMeasurement >= state.measurementInterval) {
+            _samplerState = SAMPLER_ADC;
+            _scanStep = 0;
+            state.lastMeasurement = now;
+        }
+    }
+
+    bool measuring() const { return _samplerState != SAMPLER_IDLE; }
+
+    // Milliseconds until updateSensorReadings() or startMeasurement() has
+    // work to do (0 = now)
+    unsigned long nextStep(unsigned long now) const {
+        unsigned long due;
+        switch (_samplerState) {
+            case SAMPLER_IDLE:
+                due = state.lastMeasurement + state.measurementInterval;
+                break;
+            case SAMPLER_ADC:
+                due = _scanStep > 0 ? _lastAdcSample + SOIL_STEP_SPACING : now;
+                break;
+            case SAMPLER_DHT_WAIT:
+                return 1;  // start pulse length is up to the driver
+            default:
+                return 0;
+        }
+        return (long)(due - now) > 0 ? due - now : 0;
+    }
+
+    // Runs one step of the acquisition cycle: one ADC sample per call, then
+    // the DHT start pulse and, once it has elapsed, the DHT data transfer.
+    // With the mux, samples go round-robin over the probes and each read
+    // selects the next channel, so it settles while the loop does other work.
+    // Returns true when a complete set of readings is in state.
+    bool updateSensorReadings(unsigned long now) {
+        switch (_samplerState) {
+            case SAMPLER_IDLE:
+                return false;
+
+            case SAMPLER_ADC: {
+                if (_scanStep > 0 && now - _lastAdcSample < SOIL_STEP_SPACING) {
+                    return false;
+                }
+                uint8_t probe = _scanStep % SOIL_PROBE_COUNT;
+                uint16_t raw = halAnalogRead(SOIL_MOISTURE_PIN);
+                wizard.sample(probe, raw);
+                _filters[probe].update(raw);
+                _scanStep++;
+                _lastAdcSample = now;
+                if (SOIL_PROBE_COUNT > 1) {
+                    // Back to channel 0 after the last read, ready for the next scan
+                    selectProbe(_scanStep % SOIL_PROBE_COUNT);
+                }
+                if (_scanStep >= SOIL_PROBE_COUNT * SOIL_SAMPLE_COUNT) {
+                    _samplerState = SAMPLER_DHT_START;
+                }
+                return false;
+            }
+
+            case SAMPLER_DHT_START:
+                _dht.begin(now);
+                _samplerState = SAMPLER_DHT_WAIT;
+                return false;
+
+            case SAMPLER_DHT_WAIT:
+                if (!_dht.ready(now)) {
+                    return false;
+                }
+                break;
+        }
+
+        _samplerState = SAMPLER_IDLE;
+
+        // Map each probe's filtered reading through its calibration; the
+        // sampling rate reacts to any single probe moving
+        long rawSum = 0;
+        long moistureSum = 0;
+        bool moving = false;
+        for (uint8_t i = 0; i < SOIL_PROBE_COUNT; i++) {
+            uint16_t raw = _filters[i].value();
+            int16_t moisture = probeMoisture(i, raw);
+            if (abs(moisture - state.probes.moisture[i]) > MOISTURE_STABLE_BAND * 10) {
+                moving = true;
+            }
+            state.probes.raw[i] = raw;
+            state.probes.moisture[i] = moisture;
+            rawSum += raw;
+            moistureSum += moisture;
+        }
+        _rawValue = rawSum / SOIL_PROBE_COUNT;
+        state.soilMoisture = moistureSum / (SOIL_PROBE_COUNT * 10.0f);
+        _meanMoisture = moistureSum / SOIL_PROBE_COUNT;
+        for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+            _response[i].advance(now, state.activeZone == i);
+            _response[i].reading(zoneMoisture(i), now);
+        }
+        rankZones();
+
+        // Read temperature and humidity
+        if (_dht.finish()) {
+            state.temperature = _dht.temperature();
+            state.humidity = _dht.humidity();
+            state.sensorError = false;
+            uint16_t deficit = vaporDeficit((int16_t)lroundf(state.temperature * 10),
+                                            (int16_t)lroundf(state.humidity * 10));
+            for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+                _forecast[i].reading(zoneMoisture(i), deficit, now,
+                                     state.activeZone != i && !_response[i].soaking());
+            }
+        } else {
+            state.sensorError = true;
+            state.sensorErrorCount++;
+        }
+        adaptInterval(moving);
+        return true;
+    }
+
+    // Moisture in 0.1 % for a filtered ADC reading of one probe
+    int16_t probeMoisture(uint8_t probe, uint16_t raw) const {
+        return _curves[probe].convert(raw);
+    }
+
+    // Replaces a probe's calibration curve; fewer than 2 points goes back
+    // to the built-in table. False if the points are not strictly rising
+    // in counts or a moisture is outside 0-100 %.
+    bool setCalibration(uint8_t probe, const CalPoint *points, uint8_t count) {
+        if (probe >= SOIL_PROBE_COUNT || count > CAL_POINTS_MAX) {
+            return false;
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            if (points[i].moisture < 0 || points[i].moisture > 1000 ||
+                (i > 0 && points[i].raw <= points[i - 1].raw)) {
+                return false;
+            }
+        }
+        if (count > 0) {
+            memcpy(calibration.points[probe], points, count * sizeof(CalPoint));
+        }
+        calibration.count[probe] = count;
+        _curves[probe].setCurve(points, count);
+        return true;
+    }
+
+    // Rebuilds every probe's lookup from calibration, e.g. after loading
+    // saved curves at boot; a probe with an invalid curve is reset
+    void applyCalibration() {
+        for (uint8_t i = 0; i < SOIL_PROBE_COUNT; i++) {
+            CalPoint points[CAL_POINTS_MAX];
+            uint8_t count = calibration.count[i] <= CAL_POINTS_MAX ? calibration.count[i] : 0;
+            memcpy(points, calibration.points[i], sizeof(points));
+            if (!setCalibration(i, points, count)) {
+                setCalibration(i, points, 0);
+            }
+        }
+    }
+
+    // Back to the fastest rate while the pump runs or moisture is moving;
+    // each stable reading doubles the interval up to MEASUREMENT_INTERVAL_MAX.
+    // With forecastSampling it may go on to FORECAST_INTERVAL_MAX, keeping
+    // FORECAST_SAMPLES readings before the first zone is due to need water.
+    void adaptInterval(bool moving) {
+        if (state.pumpActive || moving || state.sensorError || wizard.capturing()) {
+            state.measurementInterval = MEASUREMENT_INTERVAL;
+            return;
+        }
+        unsigned long longest = MEASUREMENT_INTERVAL_MAX;
+        unsigned long dry = nextDry();
+        if (forecastSampling && dry != ~0UL && dry / FORECAST_SAMPLES > longest) {
+            longest = dry / FORECAST_SAMPLES < FORECAST_INTERVAL_MAX
+                ? dry / FORECAST_SAMPLES : FORECAST_INTERVAL_MAX;
+        }
+        state.measurementInterval = state.measurementInterval * 2 < longest
+            ? state.measurementInterval * 2 : longest;
+    }
+
+    // Milliseconds until a zone is forecast to fall to its low threshold,
+    // counting water still soaking in; 0 if it is there, ~0UL while it has
+    // no forecast
+    unsigned long dryIn(uint8_t zone) const {
+        return _forecast[zone].dryIn(_response[zone].settled(zoneMoisture(zone)),
+                                     zones[zone].moistureThresholdLow * 10);
+    }
+
+    // Forecast drying rate of a zone at its current moisture, 0.01 % per hour
+    int32_t dryRate(uint8_t zone) const {
+        return _forecast[zone].rate(zoneMoisture(zone));
+    }
+
+    // The soonest dryIn() of the zones auto mode waters; ~0UL if none has
+    // a forecast
+    unsigned long nextDry() const {
+        unsigned long soonest = ~0UL;
+        for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+            if (zones[i].autoMode) {
+                unsigned long dry = dryIn(i);
+                if (dry < soonest) {
+                    soonest = dry;
+                }
+            }
+        }
+        return soonest;
+    }
+
+    // Drops a long forecast interval back to MEASUREMENT_INTERVAL_MAX, e.g.
+    // when a dashboard connects
+    void limitInterval() {
+        if (state.measurementInterval > MEASUREMENT_INTERVAL_MAX) {
+            state.measurementInterval = MEASUREMENT_INTERVAL_MAX;
+        }
+    }
+
+    // Stops the pump once the zone's run length (at most PUMP_TIMEOUT) is up
+    void checkPumpTimeout(unsigned long now) {
+        if (state.pumpActive && (now - state.pumpStartTime >= _runLimit)) {
+            stopPump();
+        }
+    }
+
+    // When checkPumpTimeout() will stop the running pump
+    unsigned long pumpDeadline() const { return state.pumpStartTime + _runLimit; }
+
+    // Waters the queued zone with the largest deficit, one zone at a time and
+    // within the shared cooldown and starts-per-hour limits. An automatic
+    // run ends early once its zone reaches its high threshold: with
+    // predictStop, the moisture it will settle at once the water has soaked
+    // in. Constant time: the queue is ranked when a reading completes.
+    void runAutoMode(unsigned long now) {
+        if (state.pumpActive) {
+            if (_autoRun && zoneLevel(state.activeZone) >=
+                                zones[state.activeZone].moistureThresholdHigh * 10) {
+                stopPump();
+            }
+            return;
+        }
+        if (state.autoMode && !state.sensorError && _zoneQueue && autoModeHoldoff(now) == 0) {
+            startPump(_nextZone, true);
+        }
+    }
+
+    // Milliseconds until runAutoMode() may start a queued zone that the
+    // cooldown or the hourly start limit is holding back; 0 if none is
+    unsigned long autoModeHoldoff(unsigned long now) const {
+        if (state.pumpActive || !_zoneQueue) {
+            return 0;
+        }
+        unsigned long wait = 0;
+        if (now - state.lastPumpCycle < config.pumpCooldown) {
+            wait = state.lastPumpCycle + config.pumpCooldown - now;
+        }
+        if (now - state.lastHourReset < PUMP_CYCLE_WINDOW &&
+            state.pumpCyclesThisHour >= config.maxPumpCycles) {
+            unsigned long windowLeft = state.lastHourReset + PUMP_CYCLE_WINDOW - now;
+            if (windowLeft > wait) {
+                wait = windowLeft;
+            }
+        }
+        return wait;
+    }
+
+    // Opens the zone's valve, then starts the pump. Every start counts
+    // towards the hourly limit; manual ones are not refused by it. An
+    // automatic run with predictStop is cut to the time the zone's learned
+    // response needs to settle at the high threshold.
+    void startPump(uint8_t zone = 0, bool automatic = false) {
+        unsigned long now = halMillis();
+        if (now - state.lastHourReset >= PUMP_CYCLE_WINDOW) {
+            state.lastHourReset = now;
+            state.pumpCyclesThisHour = 0;
+        }
+        state.pumpCyclesThisHour++;
+        if (ZONE_COUNT > 1) {
+            writeValves(zone);
+        }
+        halDigitalWrite(PUMP_RELAY_PIN, RELAY_ACTIVE_LOW ? LOW : HIGH);
+        state.pumpActive = true;
+        state.activeZone = zone;
+        state.pumpStartTime = now;
+        state.measurementInterval = MEASUREMENT_INTERVAL;
+        _autoRun = automatic;
+        _runLimit = zones[zone].pumpTimeout < PUMP_TIMEOUT ? zones[zone].pumpTimeout : PUMP_TIMEOUT;
+        _response[zone].started(zoneMoisture(zone), now);
+        if (automatic && predictStop) {
+            unsigned long run = _response[zone].runFor(zoneMoisture(zone), zones[zone].moistureThresholdHigh * 10);
+            if (run < _runLimit) {
+                _runLimit = run;
+            }
+        }
+        onPumpChanged(true);
+    }
+
+    // Stops the pump, then closes the valve; the zone leaves the queue
+    void stopPump() {
+        halDigitalWrite(PUMP_RELAY_PIN, RELAY_ACTIVE_LOW ? HIGH : LOW);
+        if (ZONE_COUNT > 1) {
+            writeValves(-1);
+        }
+        if (state.activeZone >= 0) {
+            _response[state.activeZone].stopped(zoneMoisture(state.activeZone), halMillis());
+            _zoneQueue &= ~(1u << state.activeZone);
+            pickNextZone();
+        }
+        state.pumpActive = false;
+        state.activeZone = -1;
+        state.lastPumpCycle = halMillis();
+        onPumpChanged(false);
+    }
+
+    uint16_t zoneQueue() const { return _zoneQueue; }
+
+    // A zone's learned response to watering
+    const ZoneResponse &response(uint8_t zone) const { return _response[zone]; }
+
+    // A zone's learned drying rate
+    const DryForecast &forecast(uint8_t zone) const { return _forecast[zone]; }
+
+    int rawValue() const { return _rawValue; }
+
+    // Sets the soil filter stages of every probe and restarts their history
+    void configureFilters(const FilterConfig &config) {
+        for (uint8_t i = 0; i < SOIL_PROBE_COUNT; i++) {
+            _filters[i].configure(config);
+        }
+    }
+
+private:
+    // Moisture in 0.1 % that decides a zone: its own probe, or the mean of
+    // all probes when there is a single zone
+    int16_t zoneMoisture(uint8_t zone) const {
+        return ZONE_COUNT > 1 ? state.probes.moisture[zone] : _meanMoisture;
+    }
+
+    // What auto mode judges a zone by: its moisture, or with predictStop
+    // the moisture it will settle at, so water still soaking in counts
+    int16_t zoneLevel(uint8_t zone) const {
+        return predictStop ? _response[zone].settled(zoneMoisture(zone)) : zoneMoisture(zone);
+    }
+
+    // Queues zones that fell below their low threshold and drops those that
+    // reached their high one, then ranks the queue
+    void rankZones() {
+        for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+            int16_t moisture = zoneLevel(i);
+            if (!zones[i].autoMode || moisture >= zones[i].moistureThresholdHigh * 10) {
+                _zoneQueue &= ~(1u << i);
+            } else if (moisture < zones[i].moistureThresholdLow * 10) {
+                _zoneQueue |= 1u << i;
+            }
+        }
+        pickNextZone();
+    }
+
+    // The queued zone furthest below its low threshold goes next
+    void pickNextZone() {
+        int32_t worst = INT32_MIN;
+        uint16_t pending = _zoneQueue;
+        while (pending) {
+            uint8_t zone = __builtin_ctz(pending);
+            pending &= pending - 1;
+            int32_t deficit = zones[zone].moistureThresholdLow * 10 - zoneLevel(zone);
+            if (deficit > worst) {
+                worst = deficit;
+                _nextZone = zone;
+            }
+        }
+    }
+
+    // Shifts the valve states out to the 74HC595 chain, highest zone first;
+    // only the given zone is open (-1 closes all)
+    void writeValves(int8_t open) {
+        halDigitalWrite(VALVE_LATCH_PIN, LOW);
+        for (int8_t zone = ZONE_COUNT - 1; zone >= 0; zone--) {
+            halDigitalWrite(VALVE_DATA_PIN, zone == open ? HIGH : LOW);
+            halDigitalWrite(VALVE_CLOCK_PIN, HIGH);
+            halDigitalWrite(VALVE_CLOCK_PIN, LOW);
+        }
+        halDigitalWrite(VALVE_LATCH_PIN, HIGH);
+    }
+
+    // Drives the mux select lines S0-S3 for a probe
+    void selectProbe(uint8_t probe) {
+        halDigitalWrite(MUX_S0_PIN, probe & 1 ? HIGH : LOW);
+        halDigitalWrite(MUX_S1_PIN, probe & 2 ? HIGH : LOW);
+        halDigitalWrite(MUX_S2_PIN, probe & 4 ? HIGH : LOW);
+        halDigitalWrite(MUX_S3_PIN, probe & 8 ? HIGH : LOW);
+    }
+
+    enum SamplerState : uint8_t {
+        SAMPLER_IDLE,
+        SAMPLER_ADC,
+        SAMPLER_DHT_START,
+        SAMPLER_DHT_WAIT
+    };
+
+    HalDht _dht;
+    SamplerState _samplerState = SAMPLER_IDLE;
+    uint16_t _zoneQueue = 0;                    // bit per zone waiting for water
+    uint8_t _nextZone = 0;
+    bool _autoRun = false;                      // the running pump was started by auto mode
+    unsigned long _runLimit = PUMP_TIMEOUT;
+    int16_t _meanMoisture = 0;                  // 0.1 %
+    uint16_t _scanStep = 0;                     // ADC reads so far this measurement
+    MoistureLut _curves[SOIL_PROBE_COUNT];
+    ZoneResponse _response[ZONE_COUNT];
+    DryForecast _forecast[ZONE_COUNT];
+    SensorFilter _filters[SOIL_PROBE_COUNT];     // one per probe, fed every ADC sample
+    unsigned long _lastAdcSample = 0;
+    int _rawValue = 0;
+};
+
+// Decides whether a reading is worth broadcasting: a value left its deadband
+// around the last frame sent, the pump, auto or error state changed, or
+// SSE_HEARTBEAT_INTERVAL has passed
+class BroadcastDeadband {
+public:
+    bool due(const SystemState &s, unsigned long now) const {
+        if (!_sent || now - _lastSent >= SSE_HEARTBEAT_INTERVAL) {
+            return true;
+        }
+        if (s.pumpActive != _last.pumpActive || s.autoMode != _last.autoMode ||
+            s.sensorError != _last.sensorError) {
+            return true;
+        }
+        for (uint8_t i = 0; i < SOIL_PROBE_COUNT; i++) {
+            if (abs(s.probes.moisture[i] - _last.probes.moisture[i]) >= SSE_DEADBAND_MOISTURE * 10) {
+                return true;
+            }
+        }
+        return fabsf(s.soilMoisture - _last.soilMoisture) >= SSE_DEADBAND_MOISTURE ||
+               fabsf(s.temperature - _last.temperature) >= SSE_DEADBAND_TEMPERATURE ||
+               fabsf(s.humidity - _last.humidity) >= SSE_DEADBAND_HUMIDITY;
+    }
+
+    // Records the values a frame was sent with
+    void sent(const SystemState &s, unsigned long now) {
+        _last = s;
+        _lastSent = now;
+        _sent = true;
+    }
+
+private:
+    SystemState _last = {};
+    unsigned long _lastSent = 0;
+    bool _sent = false;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+#ifndef DHT_ASYNC_H
+#define DHT_ASYNC_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Sensor types (same values as the Adafruit DHT library)
+#ifndef DHT11
+#define DHT11 11
+#endif
+#ifndef DHT22
+#define DHT22 22
+#endif
+
+// Split-phase DHT11/DHT22 driver.
+// The host start pulse (20ms on DHT11) is issued by begin() and left running
+// while loop() does other work; finish() then clocks in the 40 data bits.
+// Only the bit transfer itself (~4-5ms) runs with interrupts disabled.
+// The sensor needs DHT_MIN_INTERVAL between reads, so a cycle started
+// sooner skips the line entirely and finish() repeats the last result.
+class DhtAsync {
+public:
+    DhtAsync(uint8_t pin, uint8_t type) : _pin(pin), _type(type) {}
+
+    void init() {
+        pinMode(_pin, INPUT_PULLUP);
+    }
+
+    // Pull the data line low to request a reading
+    void begin(unsigned long now) {
+        _cached = _read && now - _startTime < DHT_MIN_INTERVAL;
+        if (_cached) {
+            return;
+        }
+        pinMode(_pin, OUTPUT);
+        digitalWrite(_pin, LOW);
+        _startTime = now;
+    }
+
+    // True once the start pulse has been held long enough
+    bool ready(unsigned long now) const {
+        return _cached || now - _startTime >= (_type == DHT11 ? 20UL : 2UL);
+    }
+
+    // Release the line and read the response. Returns false on timeout or
+    // checksum mismatch; the last good values are kept in that case.
+    bool finish() {
+        if (!_cached) {
+            _ok = transfer();
+            _read = true;
+        }
+        return _ok;
+    }
+
+    float temperature() const { return _temperature; }
+    float humidity() const { return _humidity; }
+
+private:
+    static const uint32_t TIMEOUT = UINT32_MAX;
+
+    // One physical read: releases the line and clocks in the 40 bits
+    bool transfer() {
+        uint32_t pulses[80];
+        uint8_t data[5] = {0, 0, 0, 0, 0};
+
+        pinMode(_pin, INPUT_PULLUP);
+        delayMicroseconds(55);
+
+        noInterrupts();
+        if (expectPulse(LOW) == TIMEOUT || expectPulse(HIGH) == TIMEOUT) {
+            interrupts();
+            return false;
+        }
+        for (int i = 0; i < 80; i += 2) {
+            pulses[i] = expectPulse(LOW);
+            pulses[i + 1] = expectPulse(HIGH);
+        }
+        interrupts();
+
+        for (int i = 0; i < 40; i++) {
+            uint32_t lowTime = pulses[2 * i];
+            uint32_t highTime = pulses[2 * i + 1];
+            if (lowTime == TIMEOUT || highTime == TIMEOUT) {
+                return false;
+            }
+            data[i / 8] <<= 1;
+            if (highTime > lowTime) {
+                data[i / 8] |= 1;
+            }
+        }
+
+        if (data[4] != ((data[0] + data[1] + data[2] + data[3]) & 0xFF)) {
+            return false;
+        }
+
+        if (_type == DHT11) {
+            _humidity = data[0] + data[1] * 0.1f;
+            _temperature = data[2] + (data[3] & 0x0F) * 0.1f;
+            if (data[3] & 0x80) _temperature = -_temperature;
+        } else {
+            _humidity = ((data[0] << 8) | data[1]) * 0.1f;
+            _temperature = (((data[2] & 0x7F) << 8) | data[3]) * 0.1f;
+            if (data[2] & 0x80) _temperature = -_temperature;
+        }
+        return true;
+    }
+
+    // Length of the current level in microseconds (max 1ms)
+    uint32_t expectPulse(uint8_t level) {
+        uint32_t start = micros();
+        while (digitalRead(_pin) == level) {
+            if (micros() - start >= 1000) {
+                return TIMEOUT;
+            }
+        }
+        return micros() - start;
+    }
+
+    uint8_t _pin;
+    uint8_t _type;
+    unsigned long _startTime = 0;   // start pulse of the last physical read
+    bool _read = false;             // a physical read has been made
+    bool _cached = false;           // this cycle reuses it
+    bool _ok = false;               // its result
+    float _temperature = NAN;
+    float _humidity = NAN;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,160 @@
+#ifndef DRY_FORECAST_H
+#define DRY_FORECAST_H
+
+#include <stdint.h>
+#include "config.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#endif
+#endif
+
+#define FORECAST_TEMP_MIN -10          // C; the saturation table covers
+#define FORECAST_TEMP_MAX 50           // this range and is clamped outside it
+#define FORECAST_K_BITS 48             // Fraction bits of the drying coefficient
+#define FORECAST_WINDOW 7200000UL      // ms of drying per estimate
+#define FORECAST_MIN_DROP 10           // 0.1 %; a shorter drop extends the window
+#define FORECAST_DEMAND_TAU 86400000UL // ms; forecasts use the daily mean deficit
+
+// e^x by its Taylor series, for tables built by the compiler
+constexpr double forecastExp(double x) {
+    double term = 1;
+    double sum = 1;
+    for (int n = 1; n < 40; n++) {
+        term *= x / n;
+        sum += term;
+    }
+    return sum;
+}
+
+// Saturation vapour pressure in Pa per whole degree, Tetens formula
+struct SaturationTable {
+    uint16_t pascals[FORECAST_TEMP_MAX - FORECAST_TEMP_MIN + 1];
+};
+
+constexpr SaturationTable buildSaturationTable() {
+    SaturationTable table = {};
+    for (int t = FORECAST_TEMP_MIN; t <= FORECAST_TEMP_MAX; t++) {
+        table.pascals[t - FORECAST_TEMP_MIN] =
+            (uint16_t)(610.78 * forecastExp(17.27 * t / (t + 237.3)) + 0.5);
+    }
+    return table;
+}
+
+static constexpr SaturationTable SATURATION_TABLE PROGMEM = buildSaturationTable();
+
+// Vapour pressure deficit in Pa for air at temperature (0.1 C) and
+// relative humidity (0.1 %): how hard the air pulls water out of the soil
+inline uint16_t vaporDeficit(int16_t temperature, int16_t humidity) {
+    int32_t t = temperature;
+    if (t < FORECAST_TEMP_MIN * 10) t = FORECAST_TEMP_MIN * 10;
+    if (t > FORECAST_TEMP_MAX * 10) t = FORECAST_TEMP_MAX * 10;
+    int32_t offset = t - FORECAST_TEMP_MIN * 10;
+    uint8_t index = offset / 10;
+    int32_t saturation = pgm_read_word(&SATURATION_TABLE.pascals[index]);
+    if (offset % 10) {
+        int32_t next = pgm_read_word(&SATURATION_TABLE.pascals[index + 1]);
+        saturation += (next - saturation) * (offset % 10) / 10;
+    }
+    int32_t dry = 1000 - (humidity < 0 ? 0 : (humidity > 1000 ? 1000 : humidity));
+    return (uint16_t)(saturation * dry / 1000);
+}
+
+// When one zone will dry out to its low threshold, all integer math.
+//
+// Between waterings soil loses water at a rate that scales with the vapour
+// pressure deficit of the air and with how much water is left:
+// dm/dt = -k * VPD * m. Each FORECAST_WINDOW of undisturbed drying (no
+// pump, nothing soaking in) gives one estimate of k, the moisture lost over
+// the deficit and moisture the soil was exposed to; the first sets k, later
+// ones move it a quarter of the way. Windows end on time rather than on
+// the drop, which would favour readings that noise pulled down. The
+// forecast applies k to the daily mean deficit, so it does not swing
+// between noon and night.
+class DryForecast {
+public:
+    // A completed reading with the air's deficit; drying is false while
+    // the zone is watered or water is still soaking in, which restarts
+    // the current window
+    void reading(int16_t moisture, uint16_t deficit, unsigned long now, bool drying) {
+        unsigned long dt = now - _last;
+        _last = now;
+        if (_demand == 0) {
+            _demand = (int32_t)deficit << 8;
+        } else {
+            // Implicit step, like ZoneResponse::advance()
+            _demand += (int32_t)((((int64_t)deficit << 8) - _demand) * (int64_t)dt /
+                                 (int64_t)(FORECAST_DEMAND_TAU + dt));
+        }
+
+        if (!drying || !_anchored) {
+            restart(moisture);
+            return;
+        }
+        _exposure += (int64_t)deficit * moisture * (int64_t)dt;
+        int32_t drop = _anchor - moisture;
+        if (drop < 0) {
+            restart(moisture);
+        } else if (now - _started >= FORECAST_WINDOW && drop >= FORECAST_MIN_DROP && _exposure > 0) {
+            int64_t k = ((int64_t)drop << FORECAST_K_BITS) / _exposure;
+            if (_windows == 0) {
+                _k = k;
+            } else {
+                _k += (k - _k) / 4;
+            }
+            _windows++;
+            restart(moisture);
+        }
+    }
+
+    // Milliseconds until a zone now at level (0.1 %) falls to low: 0 if it
+    // already has, ~0UL before the first estimate. Uses the drying rate
+    // half way down, within 4 % of the exponential for a halving.
+    unsigned long dryIn(int16_t level, int16_t low) const {
+        if (level <= low) {
+            return 0;
+        }
+        int64_t rate = _k * (_demand >> 8) * ((level + low) / 2);
+        if (rate <= 0) {
+            return ~0UL;
+        }
+        uint64_t ms = ((int64_t)(level - low) << FORECAST_K_BITS) / rate;
+        return ms < ~0UL - 1 ? (unsigned long)ms : ~0UL - 1;
+    }
+
+    // Forecast drying rate at level (0.1 %), in 0.01 % per hour. perMs
+    // stays under 2^37, the limit for the product, below ~7000 % per day.
+    int32_t rate(int16_t level) const {
+        int64_t perMs = _k * (_demand >> 8) * level;
+        return (int32_t)((perMs * 36000000LL) >> FORECAST_K_BITS);
+    }
+
+    bool learned() const { return _k > 0; }
+    uint32_t windows() const { return _windows; }
+    uint16_t demand() const { return _demand >> 8; }  // Pa, daily mean
+
+private:
+    void restart(int16_t moisture) {
+        _anchor = moisture;
+        _started = _last;
+        _exposure = 0;
+        _anchored = true;
+    }
+
+    int64_t _k = 0;             // 0.1 % per ms per Pa per 0.1 %, FORECAST_K_BITS fixed point; 0 = unknown
+    int64_t _exposure = 0;      // Pa * 0.1 % * ms since the window began
+    int32_t _demand = 0;        // Pa, 8 fraction bits
+    int16_t _anchor = 0;        // moisture when the window began
+    bool _anchored = false;
+    unsigned long _started = 0; // when the window began
+    unsigned long _last = 0;
+    uint32_t _windows = 0;      // drying windows learned from
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef FILTERS_H
+#define FILTERS_H
+
+#include <stdint.h>
+
+#define FILTER_MEDIAN_MAX 7      // Longest median window
+#define FILTER_FRAC_BITS 8       // Fraction bits of the EMA and Kalman state
+#define FILTER_KALMAN_MAX 0xFFFF // Variance ceiling, keeps the gain in 32 bits
+
+// Per-stage settings of a SensorFilter; a stage set to 0 is skipped
+struct FilterConfig {
+    uint8_t medianWindow;  // samples, odd, up to FILTER_MEDIAN_MAX (1 = off)
+    uint8_t emaShift;      // smoothing factor 1/2^emaShift
+    uint16_t kalmanQ;      // process noise variance, 1/16 count^2 per sample
+    uint16_t kalmanR;      // measurement noise variance, 1/16 count^2 (0 = off)
+};
+
+// Streaming filter for one integer sensor channel, all integer math (the
+// ESP8266 has no FPU). Samples pass a median-of-N window that drops single
+// spikes, then an exponential moving average, then a 1-D Kalman filter
+// with a constant-value model. The EMA and Kalman state carry
+// FILTER_FRAC_BITS of fraction so small steps are not lost to rounding.
+class SensorFilter {
+public:
+    void configure(const FilterConfig &config) {
+        _config = config;
+        if (_config.medianWindow > FILTER_MEDIAN_MAX) {
+            _config.medianWindow = FILTER_MEDIAN_MAX;
+        }
+        reset();
+    }
+
+    // Forgets the history; the next sample primes every stage
+    void reset() {
+        _filled = 0;
+        _next = 0;
+        _primed = false;
+    }
+
+    // Feeds one sample; returns the filtered value
+    int16_t update(int16_t sample) {
+        int32_t x = (int32_t)median(sample) << FILTER_FRAC_BITS;
+        if (!_primed) {
+            _ema = x;
+            _estimate = x;
+            _variance = _config.kalmanR;
+            _primed = true;
+        }
+        if (_config.emaShift > 0) {
+            _ema += (x - _ema) >> _config.emaShift;
+            x = _ema;
+        }
+        if (_config.kalmanR > 0) {
+            uint32_t variance = _variance + _config.kalmanQ;
+            if (variance > FILTER_KALMAN_MAX) {
+                variance = FILTER_KALMAN_MAX;
+            }
+            uint32_t gain = (variance << 16) / (variance + _config.kalmanR);  // Q16
+            _estimate += (int32_t)(((int64_t)gain * (x - _estimate)) >> 16);
+            _variance = variance - ((gain * variance) >> 16);
+            x = _estimate;
+        }
+        _value = (x + (1 << (FILTER_FRAC_BITS - 1))) >> FILTER_FRAC_BITS;
+        return _value;
+    }
+
+    int16_t value() const { return _value; }
+
+private:
+    // Median of the last medianWindow samples (fewer until the window fills)
+    int16_t median(int16_t sample) {
+        if (_config.medianWindow <= 1) {
+            return sample;
+        }
+        _window[_next] = sample;
+        _next = _next + 1 < _config.medianWindow ? _next + 1 : 0;
+        if (_filled < _config.medianWindow) {
+            _filled++;
+        }
+        int16_t sorted[FILTER_MEDIAN_MAX];
+        for (uint8_t i = 0; i < _filled; i++) {
+            int16_t v = _window[i];
+            uint8_t j = i;
+            for (; j > 0 && sorted[j - 1] > v; j--) {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = v;
+        }
+        return sorted[_filled / 2];
+    }
+
+    FilterConfig _config = {};
+    int16_t _window[FILTER_MEDIAN_MAX] = {};
+    uint8_t _filled = 0;
+    uint8_t _next = 0;
+    bool _primed = false;
+    int32_t _ema = 0;        // FILTER_FRAC_BITS fixed point
+    int32_t _estimate = 0;   // FILTER_FRAC_BITS fixed point
+    uint32_t _variance = 0;  // 1/16 count^2
+    int16_t _value = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef HAL_H
+#define HAL_H
+
+// Hardware access used by the control logic (controller.h). On the board
+// these map straight onto the Arduino core; the host build (host/) supplies
+// host_hal.h with a virtual clock and the soil/pump simulator behind them.
+
+// Radio sleep modes for halSleepMode()
+#define HAL_SLEEP_NONE 0
+#define HAL_SLEEP_MODEM 1
+#define HAL_SLEEP_LIGHT 2
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include "dht_async.h"
+
+typedef DhtAsync HalDht;
+
+inline unsigned long halMillis() { return millis(); }
+inline unsigned long halMicros() { return micros(); }
+inline int halAnalogRead(uint8_t pin) { return analogRead(pin); }
+inline void halPinMode(uint8_t pin, uint8_t mode) { pinMode(pin, mode); }
+inline void halDigitalWrite(uint8_t pin, uint8_t level) { digitalWrite(pin, level); }
+
+// Light sleep wakes for every listenInterval-th DTIM beacon
+inline void halSleepMode(uint8_t mode, uint8_t listenInterval) {
+    WiFi.setSleepMode(mode == HAL_SLEEP_LIGHT ? WIFI_LIGHT_SLEEP :
+                      mode == HAL_SLEEP_MODEM ? WIFI_MODEM_SLEEP : WIFI_NONE_SLEEP,
+                      listenInterval);
+}
+
+// Idles for ms; with light sleep selected the SDK sleeps the chip meanwhile
+inline void halIdle(unsigned long ms) { delay(ms); }
+
+// Settings flash for config_store.h: the EEPROM sector and the spare sector
+// below it, which layouts with a filesystem of 512 KB or more leave free
+// (8 KB filesystem blocks). False when that sector is part of the filesystem.
+#define HAL_FLASH_SECTOR_SIZE 4096
+extern "C" uint32_t _FS_end;
+extern "C" uint32_t _EEPROM_start;
+
+inline bool halConfigSectors(uint32_t &first) {
+    uint32_t eeprom = (uint32_t)&_EEPROM_start - 0x40200000;
+    uint32_t fsEnd = (uint32_t)&_FS_end - 0x40200000;
+    if (eeprom < fsEnd + HAL_FLASH_SECTOR_SIZE) {
+        return false;
+    }
+    first = eeprom / HAL_FLASH_SECTOR_SIZE - 1;
+    return true;
+}
+
+// Word-aligned flash access; a write can only clear bits until the sector
+// is erased
+inline bool halFlashErase(uint32_t sector) { return ESP.flashEraseSector(sector); }
+inline bool halFlashRead(uint32_t address, uint32_t *data, size_t size) { return ESP.flashRead(address, data, size); }
+inline bool halFlashWrite(uint32_t address, const uint32_t *data, size_t size) { return ESP.flashWrite(address, data, size); }
+
+#else
+
+#include "host_hal.h"
+
+#endif
+
+#endif
\ No newline at end of file
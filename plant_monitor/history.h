@@ -0,0 +1,216 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Tier layout: 1s for 10 minutes, 1 min for 24 hours, 15 min for a week
+#define HISTORY_TIER_COUNT 3
+#define HISTORY_TIER0_PERIOD 1
+#define HISTORY_TIER0_SIZE 600
+#define HISTORY_TIER1_PERIOD 60
+#define HISTORY_TIER1_SIZE 1440
+#define HISTORY_TIER2_PERIOD 900
+#define HISTORY_TIER2_SIZE 672
+
+// Adaptive sampling leaves up to this many seconds between readings; tier 0
+// repeats the previous reading across a hole that short instead of a gap
+#ifndef HISTORY_HOLD_SECONDS
+#define HISTORY_HOLD_SECONDS 30
+#endif
+
+// One reading, all values in tenths (0.1 %, 0.1 C, 0.1 %RH)
+struct HistoryPoint {
+    int16_t moisture;
+    int16_t temperature;
+    int16_t humidity;
+};
+
+#define READING_GAP 0x3FF
+
+inline int32_t clampTo(int32_t value, int32_t low, int32_t high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+// Quantizes a reading into 24 bits (also the telemetry log payload):
+//   bits 0-9   moisture in 0.1 %  (0-100.0, READING_GAP marks a gap)
+//   bits 10-16 temperature in 0.5 C steps from -20 C (-20..43.5)
+//   bits 17-23 humidity in 1 %RH
+inline uint32_t packReading(const HistoryPoint &p) {
+    uint32_t moisture = clampTo(p.moisture, 0, 1000);
+    uint32_t temperature = clampTo((p.temperature + 200 + 2) / 5, 0, 127);
+    uint32_t humidity = clampTo((p.humidity + 5) / 10, 0, 127);
+    return moisture | (temperature << 10) | (humidity << 17);
+}
+
+inline HistoryPoint unpackReading(uint32_t packed) {
+    HistoryPoint p;
+    p.moisture = packed & 0x3FF;
+    p.temperature = (int16_t)(((packed >> 10) & 0x7F) * 5) - 200;
+    p.humidity = ((packed >> 17) & 0x7F) * 10;
+    return p;
+}
+
+// Fixed-size multi-resolution history. Samples are packed to 24 bits with
+// packReading() so the whole week fits in under 8 KB.
+// Timestamps are implicit: each tier keeps the time of its newest slot and
+// a missing reading is stored as a gap. Coarser tiers are rolled up
+// incrementally from the tier below as each bucket closes.
+class HistoryStore {
+public:
+    // Adds a reading; now is uptime in seconds. A second reading within the
+    // same second replaces the first in tier 0, and only the first of each
+    // second is rolled up, so a tier-1 bucket sees at most 60 inputs.
+    void record(uint32_t now, const HistoryPoint &point) {
+        bool newSlot = _tiers[0].count == 0 || now > _tiers[0].newest;
+        push(0, now, packReading(point));
+        if (newSlot) {
+            rollup(1, now, point);
+        }
+    }
+
+    static uint16_t period(uint8_t tier) {
+        static const uint16_t periods[HISTORY_TIER_COUNT] = {
+            HISTORY_TIER0_PERIOD, HISTORY_TIER1_PERIOD, HISTORY_TIER2_PERIOD
+        };
+        return periods[tier];
+    }
+
+    static uint16_t capacity(uint8_t tier) {
+        static const uint16_t sizes[HISTORY_TIER_COUNT] = {
+            HISTORY_TIER0_SIZE, HISTORY_TIER1_SIZE, HISTORY_TIER2_SIZE
+        };
+        return sizes[tier];
+    }
+
+    bool empty(uint8_t tier) const { return _tiers[tier].count == 0; }
+    uint32_t newest(uint8_t tier) const { return _tiers[tier].newest; }
+
+    uint32_t oldest(uint8_t tier) const {
+        const Tier &t = _tiers[tier];
+        return t.newest - (uint32_t)(t.count - 1) * period(tier);
+    }
+
+    // Reading stored for the slot at time; false for gaps and out-of-range
+    bool get(uint8_t tier, uint32_t time, HistoryPoint &point) const {
+        const Tier &t = _tiers[tier];
+        if (t.count == 0 || time > t.newest || time < oldest(tier)) {
+            return false;
+        }
+        uint16_t size = capacity(tier);
+        uint16_t age = (t.newest - time) / period(tier);
+        uint16_t index = (t.head + size - 1 - age) % size;
+        uint32_t packed = readSlot(tier, index);
+        if ((packed & 0x3FF) == READING_GAP) {
+            return false;
+        }
+        point = unpackReading(packed);
+        return true;
+    }
+
+private:
+    struct Tier {
+        uint16_t head;    // next slot to write
+        uint16_t count;
+        uint32_t newest;  // time of the slot before head
+    };
+
+    // Running sums of the bucket being built for a coarser tier. At most
+    // 60 clamped inputs per bucket (one per tier-0 slot, or 15 tier-1
+    // buckets), so the sums fit in 16 bits.
+    struct Rollup {
+        uint32_t bucket;
+        uint16_t moisture;
+        uint16_t temperature;  // offset by +20 C
+        uint16_t humidity;
+        uint8_t count;
+    };
+
+    uint8_t *data(uint8_t tier) {
+        return tier == 0 ? _tier0 : (tier == 1 ? _tier1 : _tier2);
+    }
+
+    const uint8_t *data(uint8_t tier) const {
+        return tier == 0 ? _tier0 : (tier == 1 ? _tier1 : _tier2);
+    }
+
+    uint32_t readSlot(uint8_t tier, uint16_t index) const {
+        const uint8_t *slot = data(tier) + index * 3;
+        return slot[0] | ((uint32_t)slot[1] << 8) | ((uint32_t)slot[2] << 16);
+    }
+
+    void writeSlot(uint8_t tier, uint32_t packed) {
+        Tier &t = _tiers[tier];
+        uint16_t size = capacity(tier);
+        uint8_t *slot = data(tier) + t.head * 3;
+        slot[0] = packed;
+        slot[1] = packed >> 8;
+        slot[2] = packed >> 16;
+        t.head = (t.head + 1) % size;
+        if (t.count < size) {
+            t.count++;
+        }
+    }
+
+    // Appends the slot for time, filling skipped slots with gaps
+    void push(uint8_t tier, uint32_t time, uint32_t packed) {
+        Tier &t = _tiers[tier];
+        if (t.count > 0) {
+            if (time <= t.newest) {
+                // Same slot again: overwrite the newest sample
+                t.head = (t.head + capacity(tier) - 1) % capacity(tier);
+                t.count--;
+                time = t.newest;
+            } else {
+                uint32_t missing = (time - t.newest) / period(tier) - 1;
+                if (missing > capacity(tier)) {
+                    missing = capacity(tier);
+                }
+                uint32_t fill = READING_GAP;
+                if (tier == 0 && missing < HISTORY_HOLD_SECONDS) {
+                    fill = readSlot(tier, (t.head + capacity(tier) - 1) % capacity(tier));
+                }
+                while (missing-- > 0) {
+                    writeSlot(tier, fill);
+                }
+            }
+        }
+        writeSlot(tier, packed);
+        t.newest = time;
+    }
+
+    // Feeds a point from tier - 1 into the bucket being built for tier
+    void rollup(uint8_t tier, uint32_t time, const HistoryPoint &point) {
+        Rollup &r = _rollups[tier - 1];
+        uint32_t bucket = time - time % period(tier);
+
+        if (r.count > 0 && bucket != r.bucket) {
+            HistoryPoint average;
+            average.moisture = r.moisture / r.count;
+            average.temperature = r.temperature / r.count - 200;
+            average.humidity = r.humidity / r.count;
+            push(tier, r.bucket, packReading(average));
+            if (tier + 1 < HISTORY_TIER_COUNT) {
+                rollup(tier + 1, r.bucket, average);
+            }
+            r.count = 0;
+        }
+        if (r.count == 0) {
+            r = {bucket, 0, 0, 0, 0};
+        }
+        r.moisture += clampTo(point.moisture, 0, 1000);
+        r.temperature += clampTo(point.temperature, -200, 435) + 200;
+        r.humidity += clampTo(point.humidity, 0, 1000);
+        r.count++;
+    }
+
+    Tier _tiers[HISTORY_TIER_COUNT] = {};
+    Rollup _rollups[HISTORY_TIER_COUNT - 1] = {};
+    uint8_t _tier0[HISTORY_TIER0_SIZE * 3];
+    uint8_t _tier1[HISTORY_TIER1_SIZE * 3];
+    uint8_t _tier2[HISTORY_TIER2_SIZE * 3];
+};
+
+static_assert(sizeof(HistoryStore) < 8192, "history must stay under 8 KB");
+
+#endif
\ No newline at end of file
@@ -0,0 +1,165 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#define PROGMEM
+#define PGM_P const char *
+#define memcpy_P memcpy
+#define strlen_P strlen
+#endif
+
+// Widest value text each field type can produce
+#define JSON_INT_MAX_CHARS 11    // "-2147483648"
+#define JSON_FIXED_MAX_CHARS 13  // "-214748364.8" plus a leading zero
+#define JSON_BOOL_MAX_CHARS 5    // "false"
+#define JSON_FIXED16_MAX_CHARS 7 // "-3276.8", an int16_t array element
+
+// Worst-case size of one "key":value, field for a PROGMEM key array.
+// Summed per payload and checked against the buffer with static_assert.
+constexpr size_t jsonFieldSize(size_t keySize, size_t valueChars) {
+    return (keySize - 1) + 4 + valueChars;
+}
+
+// Same for a "key":[v,v,...], array field of count elements
+constexpr size_t jsonArraySize(size_t keySize, size_t count, size_t valueChars) {
+    return jsonFieldSize(keySize, 2 + count * (valueChars + 1) - 1);
+}
+
+// Writes a flat JSON object (scalars and number arrays) into a
+// caller-supplied buffer without touching the heap. Keys are read from
+// flash; numbers are fixed-point integers.
+class JsonWriter {
+public:
+    JsonWriter(char *buffer, size_t size) : _buffer(buffer), _size(size) {
+        put('{');
+    }
+
+    void integer(PGM_P key, int32_t value) {
+        writeKey(key);
+        writeInt(value, 0);
+    }
+
+    // value is scaled by 10^decimals, e.g. fixed(key, 235, 1) -> 23.5
+    void fixed(PGM_P key, int32_t value, uint8_t decimals) {
+        writeKey(key);
+        writeInt(value, decimals);
+    }
+
+    // Array of fixed-point values sharing one scale
+    void fixedArray(PGM_P key, const int16_t *values, uint8_t count, uint8_t decimals) {
+        writeKey(key);
+        put('[');
+        for (uint8_t i = 0; i < count; i++) {
+            if (i > 0) {
+                put(',');
+            }
+            writeInt(values[i], decimals);
+        }
+        put(']');
+    }
+
+    void boolean(PGM_P key, bool value) {
+        writeKey(key);
+        if (value) {
+            write("true", 4);
+        } else {
+            write("false", 5);
+        }
+    }
+
+    // value is a PROGMEM string and must not need escaping
+    void text(PGM_P key, PGM_P value) {
+        writeKey(key);
+        put('"');
+        size_t len = strlen_P(value);
+        if (len > _size - _length) {
+            _overflow = true;
+            return;
+        }
+        memcpy_P(_buffer + _length, value, len);
+        _length += len;
+        put('"');
+    }
+
+    // Closes the object; returns the string, or nullptr if it did not fit
+    const char *finish() {
+        put('}');
+        if (_overflow || _length >= _size) {
+            return nullptr;
+        }
+        _buffer[_length] = '\0';
+        return _buffer;
+    }
+
+    size_t length() const { return _length; }
+
+private:
+    void put(char c) {
+        if (_length < _size) {
+            _buffer[_length++] = c;
+        } else {
+            _overflow = true;
+        }
+    }
+
+    void write(const char *text, size_t len) {
+        if (len > _size - _length) {
+            _overflow = true;
+            return;
+        }
+        memcpy(_buffer + _length, text, len);
+        _length += len;
+    }
+
+    void writeKey(PGM_P key) {
+        if (_fields++ > 0) {
+            put(',');
+        }
+        put('"');
+        size_t len = strlen_P(key);
+        if (len > _size - _length) {
+            _overflow = true;
+            return;
+        }
+        memcpy_P(_buffer + _length, key, len);
+        _length += len;
+        put('"');
+        put(':');
+    }
+
+    void writeInt(int32_t value, uint8_t decimals) {
+        char digits[JSON_FIXED_MAX_CHARS];
+        uint8_t count = 0;
+        uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+
+        // Emit digits in reverse, inserting the decimal point on the way
+        do {
+            if (decimals > 0 && count == decimals) {
+                digits[count++] = '.';
+            }
+            digits[count++] = '0' + magnitude % 10;
+            magnitude /= 10;
+        } while (magnitude > 0 || (decimals > 0 && count <= decimals));
+
+        if (value < 0) {
+            put('-');
+        }
+        while (count > 0) {
+            put(digits[--count]);
+        }
+    }
+
+    char *_buffer;
+    size_t _size;
+    size_t _length = 0;
+    uint8_t _fields = 0;
+    bool _overflow = false;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,175 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef PSTR
+#define PSTR(s) (s)
+#endif
+#ifndef memcpy_P
+#define memcpy_P memcpy
+#endif
+#ifndef strlen_P
+#define strlen_P strlen
+#endif
+#ifndef vsnprintf_P
+#define vsnprintf_P vsnprintf
+#endif
+#endif
+
+#define LOG_LEVEL_OFF 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Highest level compiled in, and a bitmask of the modules compiled in
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+#ifndef LOG_MODULES
+#define LOG_MODULES 0xFFFFFFFFUL
+#endif
+
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 1024  // bytes of formatted text waiting for the UART
+#endif
+#define LOG_LINE_MAX 112
+
+template <uint8_t MODULE, uint8_t LEVEL>
+struct LogFilter {
+    static constexpr bool enabled = LEVEL <= LOG_LEVEL && ((LOG_MODULES >> MODULE) & 1);
+};
+
+// Serial logging that never waits for the UART.
+//
+// write() formats a line (format string in flash) into a byte ring; drain()
+// copies as much as the UART FIFO takes without blocking and is called from
+// loop() when there is nothing else to do. A line that does not fit in the
+// ring is dropped whole and counted. The ring has one producer side (loop()
+// and the network callbacks, which the core never runs concurrently) and one
+// consumer, so the indices need no lock.
+//
+// Use the LOG_* macros: a disabled level or module compiles to nothing,
+// including its format string.
+class Logger {
+public:
+    // Module names are PROGMEM strings indexed by the sketch's module enum
+    explicit Logger(const char *const *moduleNames) : _moduleNames(moduleNames) {}
+
+    void write(uint8_t level, uint8_t module, const char *format, ...) {
+        char line[LOG_LINE_MAX];
+        static const char LEVELS[] = "-EWID";
+        size_t len = 0;
+        line[len++] = LEVELS[level];
+        line[len++] = ' ';
+        size_t nameLen = strlen_P(_moduleNames[module]);
+        if (nameLen > 16) nameLen = 16;
+        memcpy_P(line + len, _moduleNames[module], nameLen);
+        len += nameLen;
+        line[len++] = ':';
+        line[len++] = ' ';
+
+        // Leave room for the newline; long messages are truncated
+        size_t room = sizeof(line) - len - 1;
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf_P(line + len, room, format, args);
+        va_end(args);
+        if (written > 0) {
+            len += (size_t)written < room ? (size_t)written : room - 1;
+        }
+        line[len++] = '\n';
+        push(line, len);
+    }
+
+    // Writes pending text to out without blocking; out needs
+    // availableForWrite() and write(const uint8_t *, size_t)
+    template <class Output>
+    void drain(Output &out) {
+        if (_droppedReported != _dropped && space() >= 32) {
+            char note[32];
+            int len = snprintf(note, sizeof(note), "[%lu log lines dropped]\n",
+                               (unsigned long)(_dropped - _droppedReported));
+            _droppedReported = _dropped;
+            push(note, len);
+        }
+        size_t room = out.availableForWrite();
+        while (room > 0 && _tail != _head) {
+            uint16_t tail = _tail;
+            size_t chunk = (_head > tail ? _head : LOG_RING_SIZE) - tail;
+            if (chunk > room) chunk = room;
+            out.write((const uint8_t *)_ring + tail, chunk);
+            _tail = (tail + chunk) % LOG_RING_SIZE;
+            room -= chunk;
+        }
+    }
+
+    bool empty() const { return _head == _tail; }
+    uint32_t lines() const { return _lines; }
+    uint32_t dropped() const { return _dropped; }
+
+    static constexpr uint16_t lineCount() { return 4; }
+
+    // Prometheus lines for /api/metrics; 0 past the end
+    size_t formatLine(uint16_t n, char *out, size_t size) const {
+        switch (n) {
+            case 0: return snprintf(out, size, "# TYPE log_lines_total counter\n");
+            case 1: return snprintf(out, size, "log_lines_total %lu\n", (unsigned long)_lines);
+            case 2: return snprintf(out, size, "# TYPE log_dropped_lines_total counter\n");
+            case 3: return snprintf(out, size, "log_dropped_lines_total %lu\n", (unsigned long)_dropped);
+        }
+        return 0;
+    }
+
+private:
+    size_t space() const {
+        return (LOG_RING_SIZE - 1) - (_head + LOG_RING_SIZE - _tail) % LOG_RING_SIZE;
+    }
+
+    void push(const char *data, size_t len) {
+        if (len > space()) {
+            _dropped++;
+            return;
+        }
+        uint16_t head = _head;
+        size_t first = LOG_RING_SIZE - head;
+        if (first > len) first = len;
+        memcpy(_ring + head, data, first);
+        memcpy(_ring, data + first, len - first);
+        _head = (head + len) % LOG_RING_SIZE;
+        _lines++;
+    }
+
+    const char *const *_moduleNames;
+    char _ring[LOG_RING_SIZE];
+    volatile uint16_t _head = 0;  // written by producers
+    volatile uint16_t _tail = 0;  // written by drain()
+    uint32_t _lines = 0;
+    uint32_t _dropped = 0;
+    uint32_t _droppedReported = 0;
+};
+
+#define LOG_AT(logger, module, level, fmt, ...) \
+    do { \
+        if (LogFilter<module, level>::enabled) { \
+            (logger).write(level, module, PSTR(fmt), ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_ERROR(logger, module, fmt, ...) LOG_AT(logger, module, LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_WARN(logger, module, fmt, ...) LOG_AT(logger, module, LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_INFO(logger, module, fmt, ...) LOG_AT(logger, module, LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(logger, module, fmt, ...) LOG_AT(logger, module, LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,110 @@
+#ifndef MOISTURE_LUT_H
+#define MOISTURE_LUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#endif
+#endif
+
+#define MOISTURE_ADC_COUNTS 1024  // 10-bit ADC: one table entry per count
+#define MOISTURE_KNOT_SHIFT 4     // Runtime curves keep a knot every 16 counts
+#define MOISTURE_KNOTS ((MOISTURE_ADC_COUNTS >> MOISTURE_KNOT_SHIFT) + 1)
+
+// One calibration point: ADC counts and the moisture they mean, in 0.1 %
+struct CalPoint {
+    uint16_t raw;
+    int16_t moisture;
+};
+
+// Moisture for raw counts, linear between the two points around it and
+// held flat beyond the first and last; points are sorted by raw
+constexpr int16_t interpolateMoisture(const CalPoint *points, uint8_t count, int32_t raw) {
+    if (count == 0) {
+        return 0;
+    }
+    if (raw <= points[0].raw) {
+        return points[0].moisture;
+    }
+    for (uint8_t i = 1; i < count; i++) {
+        if (raw <= points[i].raw) {
+            int32_t span = points[i].raw - points[i - 1].raw;
+            int32_t rise = points[i].moisture - points[i - 1].moisture;
+            int32_t offset = raw - points[i - 1].raw;
+            // Rounded to the nearest 0.1 %
+            int32_t step = (2 * rise * offset + (rise < 0 ? -span : span)) / (2 * span);
+            return points[i - 1].moisture + step;
+        }
+    }
+    return points[count - 1].moisture;
+}
+
+struct MoistureTable {
+    int16_t moisture[MOISTURE_ADC_COUNTS];
+};
+
+// Every ADC count's moisture, evaluated by the compiler so the table can
+// go straight into flash:
+//   static const MoistureTable TABLE PROGMEM = buildMoistureTable(POINTS, count);
+constexpr MoistureTable buildMoistureTable(const CalPoint *points, uint8_t count) {
+    MoistureTable table = {};
+    for (int32_t raw = 0; raw < MOISTURE_ADC_COUNTS; raw++) {
+        table.moisture[raw] = interpolateMoisture(points, count, raw);
+    }
+    return table;
+}
+
+// ADC counts to moisture (0.1 %) for one probe. By default a lookup in a
+// compile-time table in flash; a curve set at runtime is resampled into
+// MOISTURE_KNOTS points in RAM and read with one interpolation step, so
+// conversion stays constant time either way.
+class MoistureLut {
+public:
+    void useTable(const MoistureTable *table) {
+        _table = table;
+        _custom = false;
+    }
+
+    // Switches to a runtime curve (points sorted by raw; fewer than 2
+    // points goes back to the table)
+    void setCurve(const CalPoint *points, uint8_t count) {
+        if (count < 2) {
+            _custom = false;
+            return;
+        }
+        for (uint16_t knot = 0; knot < MOISTURE_KNOTS; knot++) {
+            _knots[knot] = interpolateMoisture(points, count, (int32_t)knot << MOISTURE_KNOT_SHIFT);
+        }
+        _custom = true;
+    }
+
+    bool custom() const { return _custom; }
+
+    int16_t convert(uint16_t raw) const {
+        if (raw >= MOISTURE_ADC_COUNTS) {
+            raw = MOISTURE_ADC_COUNTS - 1;
+        }
+        if (!_custom) {
+            return (int16_t)pgm_read_word(&_table->moisture[raw]);
+        }
+        uint16_t knot = raw >> MOISTURE_KNOT_SHIFT;
+        int32_t fraction = raw & ((1 << MOISTURE_KNOT_SHIFT) - 1);
+        int32_t rise = _knots[knot + 1] - _knots[knot];
+        return _knots[knot] + ((rise * fraction) >> MOISTURE_KNOT_SHIFT);
+    }
+
+private:
+    const MoistureTable *_table = nullptr;
+    int16_t _knots[MOISTURE_KNOTS] = {};
+    bool _custom = false;
+};
+
+#endif
\ No newline at end of file
@@ -1,25 +1,270 @@
 #include <ESP8266WiFi.h>
 #include <ESPAsyncTCP.h>
 #include <ESPAsyncWebServer.h>
-#include <DHT.h>
 #include "config.h"
+#include "config_store.h"
+#include "controller.h"
+#include "history.h"
+#include "heap_metrics.h"
+#include "json_writer.h"
+#include "logger.h"
+#include "power.h"
+#include "scheduler.h"
+#include "loop_metrics.h"
+#include "telemetry_log.h"
 #include "webui.h"
 
 AsyncWebServer server(SERVER_PORT);
 AsyncEventSource events("/events");
-DHT dht(DHT_PIN, DHT_TYPE);
-
-// Global state
-float soilMoisture = 0;
-float temperature = 0;
-float humidity = 0;
-bool pumpActive = false;
-bool autoMode = true;
-bool sensorError = false;
-unsigned long lastMeasurement = 0;
-unsigned long lastWiFiCheck = 0;
-unsigned long pumpStartTime = 0;
-unsigned long lastPumpStop = 0;
+
+// Sensor acquisition and pump control (shared with the host build)
+PlantController controller;
+SystemState &state = controller.state;
+BroadcastDeadband broadcastDeadband;
+PowerManager power;
+
+// Thresholds, pump limits, auto mode and power profile, kept in flash
+ConfigStore configStore;
+
+// One SSE sensor frame; in low power frames are held here and sent together
+struct SensorFrame {
+    HistoryPoint reading;
+    int16_t probes[SOIL_PROBE_COUNT];  // 0.1 %
+    int16_t dryIn[ZONE_COUNT];         // minutes until each zone is forecast dry, -1 unknown
+    uint32_t logTime;
+    uint32_t sampleInterval;
+    bool pumpActive;
+    int8_t activeZone;
+    bool autoMode;
+    bool sensorError;
+};
+SensorFrame sseBatch[POWER_BATCH_SIZE];
+uint8_t sseBatchCount = 0;
+unsigned long sseBatchStart = 0;
+
+// loop() work, highest priority first (registration order in setup())
+enum TaskId : uint8_t {
+    TASK_PUMP_TIMEOUT,
+    TASK_SENSORS,
+    TASK_AUTO_MODE,
+    TASK_PUBLISH,
+    TASK_WIFI,
+    TASK_HEAP,
+    TASK_CONSOLE,
+    TASK_CONFIG,
+    TASK_TELEMETRY,
+    TASK_LOG
+};
+static const char TASK_NAME_PUMP_TIMEOUT[] PROGMEM = "pump_timeout";
+static const char TASK_NAME_SENSORS[] PROGMEM = "sensors";
+static const char TASK_NAME_AUTO_MODE[] PROGMEM = "auto_mode";
+static const char TASK_NAME_PUBLISH[] PROGMEM = "publish";
+static const char TASK_NAME_WIFI[] PROGMEM = "wifi";
+static const char TASK_NAME_HEAP[] PROGMEM = "heap";
+static const char TASK_NAME_CONSOLE[] PROGMEM = "console";
+static const char TASK_NAME_CONFIG[] PROGMEM = "config";
+static const char TASK_NAME_TELEMETRY[] PROGMEM = "telemetry";
+static const char TASK_NAME_LOG[] PROGMEM = "log";
+Scheduler scheduler;
+
+// Worst-case loop() iteration time since the last report
+unsigned long loopMaxMicros = 0;
+
+// Serial log, drained from loop() when idle
+enum LogModule : uint8_t {
+    MODULE_SENSOR,
+    MODULE_PUMP,
+    MODULE_WIFI,
+    MODULE_HEAP,
+    MODULE_CONFIG
+};
+static const char MODULE_NAME_SENSOR[] PROGMEM = "sensor";
+static const char MODULE_NAME_PUMP[] PROGMEM = "pump";
+static const char MODULE_NAME_WIFI[] PROGMEM = "wifi";
+static const char MODULE_NAME_HEAP[] PROGMEM = "heap";
+static const char MODULE_NAME_CONFIG[] PROGMEM = "config";
+static const char *const LOG_MODULE_NAMES[] = {
+    MODULE_NAME_SENSOR, MODULE_NAME_PUMP, MODULE_NAME_WIFI, MODULE_NAME_HEAP, MODULE_NAME_CONFIG
+};
+Logger logger(LOG_MODULE_NAMES);
+
+// loop() stages timed for /api/metrics
+enum LoopStage : uint8_t {
+    STAGE_WIFI,
+    STAGE_SENSORS,
+    STAGE_SERIAL,
+    STAGE_RECORD,
+    STAGE_SSE,
+    STAGE_PUMP_TIMEOUT,
+    STAGE_AUTO_MODE,
+    STAGE_COUNT
+};
+
+#if LOOP_METRICS
+static const char STAGE_NAME_WIFI[] PROGMEM = "wifi";
+static const char STAGE_NAME_SENSORS[] PROGMEM = "sensors";
+static const char STAGE_NAME_SERIAL[] PROGMEM = "serial";
+static const char STAGE_NAME_RECORD[] PROGMEM = "record";
+static const char STAGE_NAME_SSE[] PROGMEM = "sse";
+static const char STAGE_NAME_PUMP_TIMEOUT[] PROGMEM = "pump_timeout";
+static const char STAGE_NAME_AUTO_MODE[] PROGMEM = "auto_mode";
+static const char *const LOOP_STAGE_NAMES[STAGE_COUNT] = {
+    STAGE_NAME_WIFI, STAGE_NAME_SENSORS, STAGE_NAME_SERIAL, STAGE_NAME_RECORD,
+    STAGE_NAME_SSE, STAGE_NAME_PUMP_TIMEOUT, STAGE_NAME_AUTO_MODE
+};
+LoopMetrics<STAGE_COUNT> loopMetrics(LOOP_STAGE_NAMES);
+#endif
+
+// Heap users tracked for /api/metrics
+enum HeapSubsystem : uint8_t {
+    HEAP_SSE,
+    HEAP_LOG,
+    HEAP_STATUS,
+    HEAP_HISTORY,
+    HEAP_EXPORT,
+    HEAP_METRICS_ENDPOINT,
+    HEAP_CONTROL,
+    HEAP_SUBSYSTEM_COUNT
+};
+
+#if HEAP_METRICS
+static const char HEAP_NAME_SSE[] PROGMEM = "sse";
+static const char HEAP_NAME_LOG[] PROGMEM = "log";
+static const char HEAP_NAME_STATUS[] PROGMEM = "status";
+static const char HEAP_NAME_HISTORY[] PROGMEM = "history";
+static const char HEAP_NAME_EXPORT[] PROGMEM = "export";
+static const char HEAP_NAME_METRICS[] PROGMEM = "metrics";
+static const char HEAP_NAME_CONTROL[] PROGMEM = "control";
+static const char *const HEAP_SUBSYSTEM_NAMES[HEAP_SUBSYSTEM_COUNT] = {
+    HEAP_NAME_SSE, HEAP_NAME_LOG, HEAP_NAME_STATUS, HEAP_NAME_HISTORY,
+    HEAP_NAME_EXPORT, HEAP_NAME_METRICS, HEAP_NAME_CONTROL
+};
+HeapMetrics<HEAP_SUBSYSTEM_COUNT> heapMetrics(HEAP_SUBSYSTEM_NAMES);
+#endif
+
+// Sensor history for /api/history, indexed by uptime in seconds
+HistoryStore history;
+uint32_t uptimeSeconds = 0;
+unsigned long lastUptimeTick = 0;
+
+// Flash-backed sensor and pump event log
+TelemetryLog telemetryLog;
+uint8_t activeExports = 0;
+
+// Export row keys and record type names, kept in flash
+static const char KEY_TIME[] PROGMEM = "time";
+static const char KEY_TYPE[] PROGMEM = "type";
+static const char KEY_MOISTURE[] PROGMEM = "moisture";
+static const char LOG_TYPE_SENSOR[] PROGMEM = "sensor";
+static const char LOG_TYPE_SENSOR_ERROR[] PROGMEM = "sensor_error";
+static const char LOG_TYPE_PUMP_ON[] PROGMEM = "pump_on";
+static const char LOG_TYPE_PUMP_OFF[] PROGMEM = "pump_off";
+static const char LOG_TYPE_BOOT[] PROGMEM = "boot";
+static const char *const LOG_TYPE_NAMES[] = {
+    LOG_TYPE_SENSOR, LOG_TYPE_SENSOR_ERROR, LOG_TYPE_PUMP_ON, LOG_TYPE_PUMP_OFF, LOG_TYPE_BOOT
+};
+
+// Status payload schema, keys kept in flash
+static const char KEY_SOIL_MOISTURE[] PROGMEM = "soil_moisture";
+static const char KEY_TEMPERATURE[] PROGMEM = "temperature";
+static const char KEY_HUMIDITY[] PROGMEM = "humidity";
+static const char KEY_PUMP_ACTIVE[] PROGMEM = "pump_active";
+static const char KEY_AUTO_MODE[] PROGMEM = "auto_mode";
+static const char KEY_SENSOR_ERROR[] PROGMEM = "sensor_error";
+static const char KEY_LOG_TIME[] PROGMEM = "log_time";
+static const char KEY_SAMPLE_INTERVAL[] PROGMEM = "sample_interval";
+static const char KEY_PROBES[] PROGMEM = "probes";
+static const char KEY_ZONE[] PROGMEM = "zone";
+static const char KEY_DRY_IN[] PROGMEM = "dry_in";
+
+// Calibration session payload (/api/calibrate)
+static const char KEY_PROBE[] PROGMEM = "probe";
+static const char KEY_STATE[] PROGMEM = "state";
+static const char KEY_SAMPLES[] PROGMEM = "samples";
+static const char KEY_CUSTOM[] PROGMEM = "custom";
+static const char KEY_RAW[] PROGMEM = "raw";
+static const char CAL_STATE_IDLE[] PROGMEM = "idle";
+static const char CAL_STATE_READY[] PROGMEM = "ready";
+static const char CAL_STATE_CAPTURING[] PROGMEM = "capturing";
+static const char *const CAL_STATE_NAMES[] = {CAL_STATE_IDLE, CAL_STATE_READY, CAL_STATE_CAPTURING};
+
+// Settings payload (/api/config)
+static const char KEY_LOW[] PROGMEM = "low";
+static const char KEY_HIGH[] PROGMEM = "high";
+static const char KEY_RUN[] PROGMEM = "run";
+static const char KEY_COOLDOWN[] PROGMEM = "cooldown";
+static const char KEY_CYCLES[] PROGMEM = "cycles";
+static const char KEY_DIRTY[] PROGMEM = "dirty";
+static const char KEY_SLOPE[] PROGMEM = "slope";
+static const char KEY_LAG[] PROGMEM = "lag";
+static const char KEY_DRY_RATE[] PROGMEM = "dry_rate";
+
+static_assert(JSON_BUFFER_SIZE >= 3 +
+              jsonFieldSize(sizeof(KEY_SOIL_MOISTURE), JSON_FIXED_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_TEMPERATURE), JSON_FIXED_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_HUMIDITY), JSON_FIXED_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_PUMP_ACTIVE), JSON_BOOL_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_AUTO_MODE), JSON_BOOL_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_SENSOR_ERROR), JSON_BOOL_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_LOG_TIME), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_SAMPLE_INTERVAL), JSON_INT_MAX_CHARS) +
+              jsonArraySize(sizeof(KEY_PROBES), SOIL_PROBE_COUNT, JSON_FIXED16_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_ZONE), JSON_INT_MAX_CHARS) +
+              jsonArraySize(sizeof(KEY_DRY_IN), ZONE_COUNT, JSON_FIXED16_MAX_CHARS),
+              "JSON_BUFFER_SIZE too small for the status payload");
+static_assert(JSON_BUFFER_SIZE >= 3 +
+              jsonFieldSize(sizeof(KEY_PROBE), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_STATE), sizeof(CAL_STATE_CAPTURING) + 1) +
+              jsonFieldSize(sizeof(KEY_SAMPLES), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_CUSTOM), JSON_BOOL_MAX_CHARS) +
+              jsonArraySize(sizeof(KEY_RAW), CAL_POINTS_MAX, JSON_FIXED16_MAX_CHARS) +
+              jsonArraySize(sizeof(KEY_MOISTURE), CAL_POINTS_MAX, JSON_FIXED16_MAX_CHARS),
+              "JSON_BUFFER_SIZE too small for the calibration payload");
+static_assert(JSON_BUFFER_SIZE >= 3 +
+              jsonFieldSize(sizeof(KEY_ZONE), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_LOW), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_HIGH), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_RUN), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_COOLDOWN), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_CYCLES), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_DIRTY), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_SLOPE), JSON_FIXED_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_LAG), JSON_INT_MAX_CHARS) +
+              jsonFieldSize(sizeof(KEY_DRY_RATE), JSON_FIXED_MAX_CHARS),
+              "JSON_BUFFER_SIZE too small for the settings payload");
+
+// Serves the pre-gzipped dashboard straight from flash, or 304 if the
+// browser already has this build of it
+void sendIndexHtml(AsyncWebServerRequest *request) {
+    AsyncWebServerResponse *response;
+    if (request->hasHeader("If-None-Match") &&
+        request->getHeader("If-None-Match")->value() == INDEX_HTML_ETAG) {
+        response = request->beginResponse(304);
+    } else {
+        response = request->beginResponse_P(200, "text/html", INDEX_HTML_GZ, INDEX_HTML_GZ_LEN);
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    response->addHeader("ETag", INDEX_HTML_ETAG);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+// Dashboard handler; keeps the If-None-Match header for ETag validation
+class IndexHandler : public AsyncWebHandler {
+public:
+    bool canHandle(AsyncWebServerRequest *request) {
+        if (request->method() != HTTP_GET || request->url() != "/") {
+            return false;
+        }
+        request->addInterestingHeader("If-None-Match");
+        return true;
+    }
+
+    void handleRequest(AsyncWebServerRequest *request) {
+        power.activity(millis());
+        sendIndexHtml(request);
+    }
+};
 
 void setup() {
     Serial.begin(115200);
@@ -27,12 +272,33 @@ void setup() {
     Serial.println("\nSoil Monitoring System starting...");
     
     // Initialize hardware
-    pinMode(PUMP_RELAY_PIN, OUTPUT);
-    digitalWrite(PUMP_RELAY_PIN, RELAY_ACTIVE_LOW ? HIGH : LOW); // Ensure pump is off
+    controller.begin();
     delay(100);
     digitalWrite(PUMP_RELAY_PIN, RELAY_ACTIVE_LOW ? HIGH : LOW); // Double check
     
-    dht.begin();
+    // Saved settings over the config.h defaults
+    StoredConfig settings;
+    captureSettings(settings);
+    settings.powerProfile = POWER_PROFILE;
+    if (configStore.begin(settings)) {
+        applySettings(settings);
+        Serial.printf("Settings loaded (commit %lu)\n", (unsigned long)configStore.sequence());
+    } else if (!configStore.ready()) {
+        Serial.println("No flash sectors for settings, using defaults");
+    } else {
+        Serial.println("No saved settings, using defaults");
+    }
+    
+    if (telemetryLog.begin(uptimeSeconds)) {
+        telemetryLog.record(uptimeSeconds, LOG_BOOT, currentReading());
+        ProbeCalibration saved;
+        if (loadCalibration(saved)) {
+            controller.calibration = saved;
+            controller.applyCalibration();
+        }
+    } else {
+        Serial.println("LittleFS mount failed, telemetry log disabled");
+    }
     
     // Initialize WiFi
     WiFi.mode(WIFI_STA);
@@ -56,90 +322,303 @@ void setup() {
     
     // Initialize web server
     initWebServer();
+    
+#if LOOP_METRICS
+    loopMetrics.calibrate();
+#endif
+#if HEAP_METRICS
+    heapMetrics.sample();
+#endif
+    
+    // Registration order is priority order and must match TaskId
+    scheduler.add(TASK_NAME_PUMP_TIMEOUT, pumpTimeoutTask, 500, true);
+    scheduler.add(TASK_NAME_SENSORS, sensorTask, 6000);
+    scheduler.add(TASK_NAME_AUTO_MODE, autoModeTask, 2000);
+    scheduler.add(TASK_NAME_PUBLISH, publishTask, 10000);
+    scheduler.add(TASK_NAME_WIFI, wifiTask, 1000);
+    scheduler.add(TASK_NAME_HEAP, heapTask, 2000);
+    scheduler.add(TASK_NAME_CONSOLE, consoleTask, 20000);
+    scheduler.add(TASK_NAME_CONFIG, configTask, 60000);
+    scheduler.add(TASK_NAME_TELEMETRY, telemetryTask, 30000);
+    scheduler.add(TASK_NAME_LOG, logTask, 1000);
+    
+    unsigned long now = millis();
+    scheduler.begin(now);
+    for (uint8_t id = TASK_SENSORS; id < scheduler.count(); id++) {
+        scheduler.wake(id, now);
+    }
+    if (state.pumpActive) {
+        scheduler.wakeAt(TASK_PUMP_TIMEOUT, controller.pumpDeadline());
+    }
+    power.begin(settings.powerProfile);
 }
 
 void loop() {
+    unsigned long loopStart = micros();
     unsigned long currentMillis = millis();
     
-    // Check WiFi status
-    if (currentMillis - lastWiFiCheck >= WIFI_CHECK_INTERVAL) {
-        static bool lastWiFiStatus = false;
-        bool currentWiFiStatus = (WiFi.status() == WL_CONNECTED);
-        
-        if (currentWiFiStatus != lastWiFiStatus) {
-            if (currentWiFiStatus) {
-                Serial.println("WiFi Connected");
-                events.send("connected", "wifi", millis());
-            } else {
-                Serial.println("WiFi Disconnected");
-                events.send("disconnected", "wifi", millis());
-                WiFi.reconnect();
-            }
-            lastWiFiStatus = currentWiFiStatus;
-        }
-        lastWiFiCheck = currentMillis;
+    // Keep a wrap-free seconds counter for the history timestamps
+    while (currentMillis - lastUptimeTick >= 1000) {
+        lastUptimeTick += 1000;
+        uptimeSeconds++;
     }
     
-    // Update sensor readings
-    if (currentMillis - lastMeasurement >= MEASUREMENT_INTERVAL) {
-        updateSensorReadings();
-        lastMeasurement = currentMillis;
-        
-        // Send real-time updates if WiFi is connected
-        if (WiFi.status() == WL_CONNECTED) {
-            String json = getSensorJson();
-            events.send(json.c_str(), "sensors", millis());
-        }
+    scheduler.run(currentMillis);
+    
+    unsigned long loopTime = micros() - loopStart;
+    if (loopTime > loopMaxMicros) {
+        loopMaxMicros = loopTime;
     }
     
-    // Check pump timeout
-    if (pumpActive && (currentMillis - pumpStartTime >= PUMP_TIMEOUT)) {
-        stopPump();
+    // Sleep until the next deadline in a low-power profile, once the log
+    // has been handed to the UART
+    unsigned long now = millis();
+    if (!logger.empty()) {
+        scheduler.wake(TASK_LOG, now);
     }
+    power.idle(now, logger.empty() ? scheduler.nextDeadline(now) : now);
     
-    // Auto mode control
-    if (autoMode && !pumpActive && !sensorError) {
-        if (soilMoisture < MOISTURE_THRESHOLD_LOW && 
-            (currentMillis - lastPumpStop >= PUMP_COOLDOWN)) {
-            startPump();
+    yield(); // Allow ESP8266 to handle system tasks
+}
+
+// Safety stop, armed by onPumpChanged() for the moment the pump times out
+uint32_t pumpTimeoutTask(uint32_t now) {
+    LOOP_PROBE(loopMetrics, STAGE_PUMP_TIMEOUT);
+    controller.checkPumpTimeout(now);
+    return state.pumpActive ? 1 : SCHED_NEVER;
+}
+
+// Steps sensor acquisition; a completed reading wakes publishing and auto mode.
+// Readings only space out by the dry forecast while no dashboard is open.
+uint32_t sensorTask(uint32_t now) {
+    controller.forecastSampling = DRY_FORECAST && events.count() == 0;
+    controller.startMeasurement(now);
+    bool measured;
+    {
+        LOOP_PROBE(loopMetrics, STAGE_SENSORS);
+        measured = controller.updateSensorReadings(now);
+    }
+    if (measured) {
+        scheduler.wake(TASK_AUTO_MODE, now);
+        scheduler.wake(TASK_PUBLISH, now);
+    }
+    return controller.nextStep(now);
+}
+
+// Runs after each reading, and again when the cooldown or hourly limit that
+// held a queued zone back ends
+uint32_t autoModeTask(uint32_t now) {
+    LOOP_PROBE(loopMetrics, STAGE_AUTO_MODE);
+    controller.runAutoMode(now);
+    unsigned long holdoff = controller.autoModeHoldoff(now);
+    return holdoff > 0 ? holdoff : SCHED_NEVER;
+}
+
+// Logs, records and broadcasts a completed reading
+uint32_t publishTask(uint32_t now) {
+    {
+        LOOP_PROBE(loopMetrics, STAGE_SERIAL);
+        printSensorReadings();
+    }
+    HistoryPoint point = currentReading();
+    {
+        LOOP_PROBE(loopMetrics, STAGE_RECORD);
+        HEAP_SCOPE(heapMetrics, HEAP_LOG);
+        history.record(uptimeSeconds, point);
+        telemetryLog.record(uptimeSeconds, state.sensorError ? LOG_SENSOR_ERROR : LOG_SENSOR, point);
+        scheduler.wake(TASK_TELEMETRY, now);
+    }
+    
+    // Send real-time updates if WiFi is connected and a value moved past
+    // its deadband (or the heartbeat is due). In low power the frame joins
+    // a batch that goes out in one radio wake-up.
+    if (WiFi.status() == WL_CONNECTED && events.count() > 0 && broadcastDeadband.due(state, now)) {
+        LOOP_PROBE(loopMetrics, STAGE_SSE);
+        HEAP_SCOPE(heapMetrics, HEAP_SSE);
+        if (sseBatchCount == 0) {
+            sseBatchStart = now;
+        }
+        sseBatch[sseBatchCount++] = currentFrame();
+        broadcastDeadband.sent(state, now);
+        if (!power.lowPower(now) || sseBatchCount == POWER_BATCH_SIZE ||
+            now - sseBatchStart >= POWER_BATCH_INTERVAL) {
+            sendSensorBatch();
         }
     }
+    return SCHED_NEVER;
+}
+
+// Sends the held frames, oldest first. Each frame is serialized once; if a
+// slow client still has frames queued the batch is dropped rather than
+// growing its queue on the heap.
+void sendSensorBatch() {
+    if (events.avgPacketsWaiting() < SSE_MAX_BACKLOG) {
+        char json[JSON_BUFFER_SIZE];
+        for (uint8_t i = 0; i < sseBatchCount; i++) {
+            if (formatSensorJson(sseBatch[i], json, sizeof(json))) {
+                events.send(json, "sensors", millis());
+            }
+        }
+    }
+    sseBatchCount = 0;
+}
+
+// Check WiFi status
+uint32_t wifiTask(uint32_t now) {
+    LOOP_PROBE(loopMetrics, STAGE_WIFI);
+    static bool lastWiFiStatus = false;
+    bool currentWiFiStatus = (WiFi.status() == WL_CONNECTED);
     
-    yield(); // Allow ESP8266 to handle system tasks
+    if (currentWiFiStatus != lastWiFiStatus) {
+        if (currentWiFiStatus) {
+            LOG_INFO(logger, MODULE_WIFI, "WiFi Connected");
+            events.send("connected", "wifi", millis());
+        } else {
+            LOG_WARN(logger, MODULE_WIFI, "WiFi Disconnected");
+            events.send("disconnected", "wifi", millis());
+            WiFi.reconnect();
+        }
+        lastWiFiStatus = currentWiFiStatus;
+    }
+    return WIFI_CHECK_INTERVAL;
+}
+
+uint32_t heapTask(uint32_t now) {
+#if HEAP_METRICS
+    heapMetrics.sample();
+#if HEAP_SOAK
+    printHeapMetrics();
+#endif
+    return HEAP_SAMPLE_INTERVAL;
+#else
+    return SCHED_NEVER;
+#endif
+}
+
+// 'm' on the serial console prints the stage timings and heap state. Polled
+// less often in low power, where each poll is a wake-up.
+uint32_t consoleTask(uint32_t now) {
+    if (Serial.available() > 0 && Serial.read() == 'm') {
+        printMetrics();
+    }
+    return power.lowPower(now) ? CONSOLE_POLL_INTERVAL_LOW : CONSOLE_POLL_INTERVAL;
+}
+
+// Writes changed settings to flash once they have settled
+uint32_t configTask(uint32_t now) {
+    if (configStore.dirty() == 0) {
+        return SCHED_NEVER;
+    }
+    unsigned long wait = configStore.commitDelay(now);
+    if (wait > 0) {
+        return wait;
+    }
+    if (!configStore.commit(now)) {
+        LOG_WARN(logger, MODULE_CONFIG, "Settings not saved to flash");
+        return CONFIG_COMMIT_INTERVAL;
+    }
+    LOG_INFO(logger, MODULE_CONFIG, "Settings saved (commit %lu, %lu us)",
+             (unsigned long)configStore.sequence(), (unsigned long)configStore.lastCommitMicros());
+    return SCHED_NEVER;
+}
+
+// Writes the telemetry log's RAM page once its first record is
+// LOG_FLUSH_AGE old, so slow sampling cannot hold hours of it unflushed
+uint32_t telemetryTask(uint32_t now) {
+    telemetryLog.flushStale(uptimeSeconds);
+    uint32_t wait = telemetryLog.flushWait(uptimeSeconds);
+    return wait == LOG_FLUSH_NONE ? SCHED_NEVER : wait * 1000;
+}
+
+// Hands buffered log text to the UART between measurements; loop() wakes it
+// while there is text, so an empty log costs no wake-ups
+uint32_t logTask(uint32_t now) {
+    if (!controller.measuring()) {
+        logger.drain(Serial);
+    }
+    return logger.empty() ? SCHED_NEVER : 0;
 }
 
 void initWebServer() {
     // Setup SSE
     events.onConnect([](AsyncEventSourceClient *client) {
+        power.activity(millis());
+        if (sseBatchCount > 0) {
+            sendSensorBatch();  // frames held back in low power, oldest first
+        }
+        controller.limitInterval();
+        scheduler.wake(TASK_SENSORS, millis());
         client->send("hello", NULL, millis(), 1000);
     });
     server.addHandler(&events);
     
     // Serve web interface
-    server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-        request->send(200, "text/html", INDEX_HTML);
-    });
+    server.addHandler(new IndexHandler());
     
     // API endpoints
     server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request) {
-        request->send(200, "application/json", getSensorJson());
+        HEAP_SCOPE(heapMetrics, HEAP_STATUS);
+        char json[JSON_BUFFER_SIZE];
+        if (getSensorJson(json, sizeof(json))) {
+            request->send(200, "application/json", json);
+        } else {
+            request->send(500);
+        }
     });
     
+    server.on("/api/history", HTTP_GET, handleHistory);
+    server.on("/api/metrics", HTTP_GET, handleMetrics);
+    server.on("/api/export", HTTP_GET, handleExport);
+    server.on("/api/calibrate", HTTP_GET, sendCalibrationStatus);
+    server.on("/api/calibrate", HTTP_POST, handleCalibrate);
+    server.on("/api/config", HTTP_GET, [](AsyncWebServerRequest *request) {
+        long zone = request->hasParam("zone") ? request->getParam("zone")->value().toInt() : 0;
+        if (zone < 0 || zone >= ZONE_COUNT) {
+            request->send(400);
+            return;
+        }
+        sendSettings(request, zone);
+    });
+    server.on("/api/config", HTTP_POST, handleConfig);
+    
     server.on("/api/control", HTTP_POST, [](AsyncWebServerRequest *request) {
+        HEAP_SCOPE(heapMetrics, HEAP_CONTROL);
+        power.activity(millis());
         if (request->hasParam("auto", true)) {
-            autoMode = (request->getParam("auto", true)->value() == "true");
+            state.autoMode = (request->getParam("auto", true)->value() == "true");
+            settingsChanged();
             request->send(200);
-            events.send(autoMode ? "auto_on" : "auto_off", "auto", millis());
+            events.send(state.autoMode ? "auto_on" : "auto_off", "auto", millis());
         }
         else if (request->hasParam("pump", true)) {
             bool shouldPump = (request->getParam("pump", true)->value() == "true");
-            if (shouldPump && !pumpActive && !sensorError) {
-                startPump();
-            } else if (!shouldPump && pumpActive) {
-                stopPump();
+            long zone = request->hasParam("zone", true) ? request->getParam("zone", true)->value().toInt() : 0;
+            if (zone < 0 || zone >= ZONE_COUNT) {
+                request->send(400);
+                return;
+            }
+            if (shouldPump && !state.pumpActive && !state.sensorError) {
+                controller.startPump(zone);
+            } else if (!shouldPump && state.pumpActive) {
+                controller.stopPump();
             }
             request->send(200);
         }
+        else if (request->hasParam("power", true)) {
+            const String &profile = request->getParam("power", true)->value();
+            if (profile == "full") {
+                power.setProfile(POWER_FULL);
+            } else if (profile == "modem") {
+                power.setProfile(POWER_MODEM_SLEEP);
+            } else if (profile == "light") {
+                power.setProfile(POWER_LIGHT_SLEEP);
+            } else {
+                request->send(400);
+                return;
+            }
+            settingsChanged();
+            request->send(200);
+        }
         else {
             request->send(400);
         }
@@ -149,68 +628,494 @@ void initWebServer() {
     Serial.println("Web server started");
 }
 
-void updateSensorReadings() {
-    // Read soil moisture with proper voltage handling
-    int rawValue = 0;
-    for (int i = 0; i < 5; i++) {
-        rawValue += analogRead(SOIL_MOISTURE_PIN);
-        delay(10);
+// Debug output for a completed measurement
+void printSensorReadings() {
+    if (state.sensorError) {
+        LOG_WARN(logger, MODULE_SENSOR, "DHT sensor error");
+    }
+    int rawValue = controller.rawValue();
+    LOG_DEBUG(logger, MODULE_SENSOR, "Raw ADC: %d, Voltage: %.2fV", rawValue, (rawValue * VOLTAGE_MAX) / ADC_MAX);
+    LOG_INFO(logger, MODULE_SENSOR, "Moisture: %.1f%%, Temp: %.1f°C, Humidity: %.1f%%",
+             state.soilMoisture, state.temperature, state.humidity);
+    LOG_DEBUG(logger, MODULE_SENSOR, "Loop max: %lu us", loopMaxMicros);
+    loopMaxMicros = 0;
+}
+
+// Writes the status payload into buffer; returns nullptr if it did not fit
+const char *getSensorJson(char *buffer, size_t size) {
+    return formatSensorJson(currentFrame(), buffer, size);
+}
+
+const char *formatSensorJson(const SensorFrame &frame, char *buffer, size_t size) {
+    JsonWriter json(buffer, size);
+    json.fixed(KEY_SOIL_MOISTURE, frame.reading.moisture, 1);
+    json.fixed(KEY_TEMPERATURE, frame.reading.temperature, 1);
+    json.fixed(KEY_HUMIDITY, frame.reading.humidity, 1);
+    json.boolean(KEY_PUMP_ACTIVE, frame.pumpActive);
+    json.boolean(KEY_AUTO_MODE, frame.autoMode);
+    json.boolean(KEY_SENSOR_ERROR, frame.sensorError);
+    json.integer(KEY_LOG_TIME, frame.logTime);
+    json.integer(KEY_SAMPLE_INTERVAL, frame.sampleInterval);
+    json.fixedArray(KEY_PROBES, frame.probes, SOIL_PROBE_COUNT, 1);
+    json.integer(KEY_ZONE, frame.activeZone);
+    json.fixedArray(KEY_DRY_IN, frame.dryIn, ZONE_COUNT, 0);
+    return json.finish();
+}
+
+SensorFrame currentFrame() {
+    SensorFrame frame;
+    frame.reading = currentReading();
+    memcpy(frame.probes, state.probes.moisture, sizeof(frame.probes));
+    frame.logTime = telemetryLog.now(uptimeSeconds);
+    frame.sampleInterval = state.measurementInterval;
+    for (uint8_t i = 0; i < ZONE_COUNT; i++) {
+        unsigned long dry = controller.dryIn(i);
+        frame.dryIn[i] = dry == ~0UL ? -1 : (dry / 60000 < INT16_MAX ? dry / 60000 : INT16_MAX);
+    }
+    frame.pumpActive = state.pumpActive;
+    frame.activeZone = state.activeZone;
+    frame.autoMode = state.autoMode;
+    frame.sensorError = state.sensorError;
+    return frame;
+}
+
+// Latest readings in the fixed-point form used by history and the log
+HistoryPoint currentReading() {
+    HistoryPoint point;
+    point.moisture = lroundf(state.soilMoisture * 10);
+    point.temperature = lroundf(state.temperature * 10);
+    point.humidity = lroundf(state.humidity * 10);
+    return point;
+}
+
+// Appends one [time,moisture,temperature,humidity] row to out
+size_t formatHistoryRow(char *out, size_t size, bool first, uint32_t time, const HistoryPoint &p) {
+    int temperature = abs(p.temperature);
+    return snprintf(out, size, "%s[%lu,%d.%d,%s%d.%d,%d]", first ? "" : ",",
+                    (unsigned long)time, p.moisture / 10, p.moisture % 10,
+                    p.temperature < 0 ? "-" : "", temperature / 10, temperature % 10,
+                    p.humidity / 10);
+}
+
+// Calibration wizard: action=start&probe=N opens a session, then
+// action=capture&moisture=P (percent) once per reference point, waiting
+// for state "ready" in between; action=save applies and stores the curve.
+// action=cancel drops the session, action=reset&probe=N restores the
+// built-in table. Answers with the session state.
+void handleCalibrate(AsyncWebServerRequest *request) {
+    HEAP_SCOPE(heapMetrics, HEAP_CONTROL);
+    power.activity(millis());
+    CalibrationWizard &wizard = controller.wizard;
+    const String action = request->hasParam("action", true) ? request->getParam("action", true)->value() : String();
+    long probe = request->hasParam("probe", true) ? request->getParam("probe", true)->value().toInt() : -1;
+    bool ok;
+    if (action == "start") {
+        ok = probe >= 0 && wizard.start(probe);
+    } else if (action == "capture") {
+        ok = request->hasParam("moisture", true) &&
+             wizard.capture(lroundf(request->getParam("moisture", true)->value().toFloat() * 10));
+        if (ok) {
+            scheduler.wake(TASK_SENSORS, millis());  // back to the fast sampling rate
+        }
+    } else if (action == "save") {
+        CalPoint points[CAL_POINTS_MAX];
+        uint8_t count;
+        ok = wizard.curve(points, count) && controller.setCalibration(wizard.probe(), points, count);
+        if (ok) {
+            wizard.cancel();
+            if (!saveCalibration(controller.calibration)) {
+                LOG_WARN(logger, MODULE_SENSOR, "Calibration not saved to flash");
+            }
+        }
+    } else if (action == "cancel") {
+        wizard.cancel();
+        ok = true;
+    } else if (action == "reset") {
+        ok = probe >= 0 && controller.setCalibration(probe, nullptr, 0);
+        if (ok && !saveCalibration(controller.calibration)) {
+            LOG_WARN(logger, MODULE_SENSOR, "Calibration not saved to flash");
+        }
+    } else {
+        ok = false;
+    }
+    if (!ok) {
+        request->send(400);
+        return;
+    }
+    sendCalibrationStatus(request);
+}
+
+void sendCalibrationStatus(AsyncWebServerRequest *request) {
+    const CalibrationWizard &wizard = controller.wizard;
+    int16_t raw[CAL_POINTS_MAX];
+    int16_t moisture[CAL_POINTS_MAX];
+    for (uint8_t i = 0; i < wizard.count(); i++) {
+        raw[i] = wizard.point(i).raw;
+        moisture[i] = wizard.point(i).moisture;
+    }
+    char json[JSON_BUFFER_SIZE];
+    JsonWriter writer(json, sizeof(json));
+    writer.integer(KEY_PROBE, wizard.probe());
+    writer.text(KEY_STATE, CAL_STATE_NAMES[wizard.state()]);
+    writer.integer(KEY_SAMPLES, wizard.samples());
+    writer.boolean(KEY_CUSTOM, controller.calibration.count[wizard.probe()] >= 2);
+    writer.fixedArray(KEY_RAW, raw, wizard.count(), 0);
+    writer.fixedArray(KEY_MOISTURE, moisture, wizard.count(), 1);
+    if (writer.finish()) {
+        request->send(200, "application/json", json);
+    } else {
+        request->send(500);
+    }
+}
+
+// POST /api/config zone=N (default 0) with any of low and high (%) and run
+// (ms) for that zone, and cooldown (ms) and cycles (starts per hour) shared
+// by all zones. Changes apply at once and reach flash once they settle.
+void handleConfig(AsyncWebServerRequest *request) {
+    HEAP_SCOPE(heapMetrics, HEAP_CONTROL);
+    power.activity(millis());
+    long zone = request->hasParam("zone", true) ? request->getParam("zone", true)->value().toInt() : 0;
+    if (zone < 0 || zone >= ZONE_COUNT) {
+        request->send(400);
+        return;
+    }
+    const SystemConfig &current = controller.zones[zone];
+    long low = intParam(request, "low", current.moistureThresholdLow);
+    long high = intParam(request, "high", current.moistureThresholdHigh);
+    long run = intParam(request, "run", current.pumpTimeout);
+    long cooldown = intParam(request, "cooldown", controller.config.pumpCooldown);
+    long cycles = intParam(request, "cycles", controller.config.maxPumpCycles);
+    if (low < 0 || low >= high || high > 100 || run <= 0 || run > PUMP_TIMEOUT ||
+        cooldown < 0 || cooldown > (long)PUMP_CYCLE_WINDOW || cycles < 1 || cycles > 255) {
+        request->send(400);
+        return;
+    }
+    controller.zones[zone].moistureThresholdLow = low;
+    controller.zones[zone].moistureThresholdHigh = high;
+    controller.zones[zone].pumpTimeout = run;
+    controller.config.pumpCooldown = cooldown;
+    controller.config.maxPumpCycles = cycles;
+    settingsChanged();
+    sendSettings(request, zone);
+}
+
+// Integer form field, or fallback when it is missing
+long intParam(AsyncWebServerRequest *request, const char *name, long fallback) {
+    return request->hasParam(name, true) ? request->getParam(name, true)->value().toInt() : fallback;
+}
+
+void sendSettings(AsyncWebServerRequest *request, uint8_t zone) {
+    char json[JSON_BUFFER_SIZE];
+    JsonWriter writer(json, sizeof(json));
+    writer.integer(KEY_ZONE, zone);
+    writer.integer(KEY_LOW, controller.zones[zone].moistureThresholdLow);
+    writer.integer(KEY_HIGH, controller.zones[zone].moistureThresholdHigh);
+    writer.integer(KEY_RUN, controller.zones[zone].pumpTimeout);
+    writer.integer(KEY_COOLDOWN, controller.config.pumpCooldown);
+    writer.integer(KEY_CYCLES, controller.config.maxPumpCycles);
+    writer.integer(KEY_DIRTY, configStore.dirty());
+    // Learned response: % per second of pumping and soak-in time in s
+    writer.fixed(KEY_SLOPE, controller.response(zone).slope(), 2);
+    writer.integer(KEY_LAG, (controller.response(zone).lag() + 500) / 1000);
+    // Forecast drying at the current moisture, % per hour
+    writer.fixed(KEY_DRY_RATE, controller.dryRate(zone), 2);
+    if (writer.finish()) {
+        request->send(200, "application/json", json);
+    } else {
+        request->send(500);
+    }
+}
+
+// The settings that persist, from the controller and power manager.
+// Cleared first so padding bytes compare and checksum the same every time.
+void captureSettings(StoredConfig &settings) {
+    memset(&settings, 0, sizeof(settings));
+    memcpy(&settings.limits, &controller.config, sizeof(settings.limits));
+    memcpy(settings.zones, controller.zones, sizeof(settings.zones));
+    settings.autoMode = state.autoMode;
+    settings.powerProfile = power.profile();
+}
+
+void applySettings(const StoredConfig &settings) {
+    memcpy(&controller.config, &settings.limits, sizeof(settings.limits));
+    memcpy(controller.zones, settings.zones, sizeof(settings.zones));
+    state.autoMode = settings.autoMode;
+}
+
+// After a settings change: marks what differs from flash and lets the
+// config task commit it once the settings settle
+void settingsChanged() {
+    StoredConfig settings;
+    captureSettings(settings);
+    unsigned long now = millis();
+    configStore.update(settings, now);
+    scheduler.wake(TASK_CONFIG, now);
+}
+
+// GET /api/history?tier=0|1|2&since=<uptime s>
+// Streams the stored samples as chunked JSON. Only the cursor is kept per
+// request; rows are formatted straight from the ring buffers into each chunk.
+void handleHistory(AsyncWebServerRequest *request) {
+    HEAP_SCOPE(heapMetrics, HEAP_HISTORY);
+    uint8_t tier = request->hasParam("tier") ? request->getParam("tier")->value().toInt() : 0;
+    if (tier >= HISTORY_TIER_COUNT) {
+        request->send(400);
+        return;
+    }
+    uint32_t since = request->hasParam("since") ? request->getParam("since")->value().toInt() : 0;
+    uint32_t period = HistoryStore::period(tier);
+    uint32_t now = uptimeSeconds;
+    uint32_t next = 1;
+    uint32_t end = 0;
+    if (!history.empty(tier)) {
+        next = max(since + (period - since % period) % period, history.oldest(tier));
+        end = history.newest(tier);
     }
-    rawValue /= 5; // Average of 5 readings
-    
-    // Convert ADC reading to voltage (NodeMCU ADC reads 0-1V)
-    float voltage = (rawValue * VOLTAGE_MAX) / ADC_MAX;
     
-    // Calculate percentage (inverted as higher voltage means drier soil)
-    // Assuming linear relationship between voltage and moisture
-    float percentage = (1.0 - (voltage / VOLTAGE_MAX)) * 100.0;
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+        [tier, period, now, next, end, stage = 0](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+            char *out = (char *)buffer;
+            size_t len = 0;
+            if (maxLen < HISTORY_ROW_MAX) {
+                return RESPONSE_TRY_AGAIN;
+            }
+            if (stage == 0) {
+                len = snprintf(out, maxLen, "{\"tier\":%u,\"period\":%lu,\"now\":%lu,\"samples\":[",
+                               tier, (unsigned long)period, (unsigned long)now);
+                stage = 1;
+            }
+            while (stage < 3 && next <= end && maxLen - len >= HISTORY_ROW_MAX) {
+                HistoryPoint point;
+                if (history.get(tier, next, point)) {
+                    len += formatHistoryRow(out + len, maxLen - len, stage == 1, next, point);
+                    stage = 2;
+                }
+                next += period;
+            }
+            if (stage < 3 && next > end && maxLen - len >= 2) {
+                out[len++] = ']';
+                out[len++] = '}';
+                stage = 3;
+            }
+            return len;
+        });
+    request->send(response);
+}
+
+// GET /api/metrics
+// Prometheus text exposition, streamed a line at a time so the size of the
+// response does not depend on free heap
+void handleMetrics(AsyncWebServerRequest *request) {
+    HEAP_SCOPE(heapMetrics, HEAP_METRICS_ENDPOINT);
+    AsyncWebServerResponse *response = request->beginChunkedResponse("text/plain; version=0.0.4",
+        [line = 0](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+            char *out = (char *)buffer;
+            size_t len = 0;
+            if (maxLen < METRICS_LINE_MAX) {
+                return RESPONSE_TRY_AGAIN;
+            }
+            while (maxLen - len >= METRICS_LINE_MAX) {
+                size_t written = formatMetricsLine(line, out + len, maxLen - len);
+                if (written == 0) {
+                    break;
+                }
+                len += written;
+                line++;
+            }
+            return len;
+        });
+    request->send(response);
+}
+
+// Line n of the /api/metrics body; 0 past the end
+size_t formatMetricsLine(uint16_t n, char *out, size_t size) {
+#if LOOP_METRICS
+    if (n < loopMetrics.lineCount()) {
+        return loopMetrics.formatLine(n, out, size);
+    }
+    n -= loopMetrics.lineCount();
+#endif
+#if HEAP_METRICS
+    if (n < heapMetrics.lineCount()) {
+        return heapMetrics.formatLine(n, out, size);
+    }
+    n -= heapMetrics.lineCount();
+#endif
+    if (n < scheduler.lineCount()) {
+        return scheduler.formatLine(n, out, size);
+    }
+    n -= scheduler.lineCount();
+    if (n < power.lineCount()) {
+        return power.formatLine(n, out, size);
+    }
+    n -= power.lineCount();
+    if (n < configStore.lineCount()) {
+        return configStore.formatLine(n, out, size);
+    }
+    n -= configStore.lineCount();
+    if (n < telemetryLog.lineCount()) {
+        return telemetryLog.formatLine(n, out, size);
+    }
+    n -= telemetryLog.lineCount();
+    return logger.formatLine(n, out, size);
+}
+
+#if HEAP_METRICS
+void printHeapMetrics() {
+    LOG_INFO(logger, MODULE_HEAP, "Heap: free=%lu min=%lu max_block=%lu min_block=%lu frag=%u%% max_frag=%u%%",
+             (unsigned long)heapMetrics.free(), (unsigned long)heapMetrics.minFree(),
+             (unsigned long)heapMetrics.maxBlock(), (unsigned long)heapMetrics.minMaxBlock(),
+             heapMetrics.fragmentation(), heapMetrics.maxFragmentation());
+}
+#endif
+
+void printMetrics() {
+    char line[METRICS_LINE_MAX];
+#if LOOP_METRICS
+    for (uint8_t stage = 0; stage < STAGE_COUNT; stage++) {
+        loopMetrics.formatSummary(stage, line, sizeof(line));
+        Serial.print(line);
+    }
+    Serial.printf("Probe overhead: %lu cycles\n", (unsigned long)loopMetrics.probeCycles());
+#endif
+#if HEAP_METRICS
+    printHeapMetrics();
+#endif
+    for (uint8_t id = 0; id < scheduler.count(); id++) {
+        scheduler.formatSummary(id, line, sizeof(line));
+        Serial.print(line);
+    }
+    Serial.printf("Power: profile %u, ~%.1f mA average, %lu sleeps, wake late max %lu ms avg %lu ms\n",
+                  power.profile(), power.averageMicroamps() / 1000.0, (unsigned long)power.sleeps(),
+                  (unsigned long)power.wakeLateMax(), (unsigned long)power.wakeLateAverage());
+    Serial.printf("Config: commit %lu, %lu failed, erases %lu/%lu, last %lu us, max %lu us, load %lu us, dirty 0x%02x\n",
+                  (unsigned long)configStore.sequence(), (unsigned long)configStore.failures(),
+                  (unsigned long)configStore.erases(0), (unsigned long)configStore.erases(1),
+                  configStore.lastCommitMicros(), configStore.maxCommitMicros(),
+                  configStore.loadMicros(), configStore.dirty());
+    Serial.printf("Telemetry: %u segments, %lu pages written, %lu segments dropped, %u records waiting, flush max %lu us\n",
+                  telemetryLog.segmentCount(), (unsigned long)telemetryLog.pagesWritten(),
+                  (unsigned long)telemetryLog.segmentsDropped(), telemetryLog.pageRecords(),
+                  telemetryLog.flushMaxMicros());
+}
+
+// Per-request export state: the log cursor (one page buffer) plus the row
+// that did not fit into the previous chunk. Freed with the response.
+struct ExportState {
+    LogCursor cursor;
+    uint32_t to;
+    bool csv;
+    bool started;
+    bool pending;
+    LogEntry entry;
     
-    // Constrain to valid range
-    soilMoisture = constrain(percentage, 0, 100);
+    ExportState() : cursor(telemetryLog), started(false), pending(false) {
+        activeExports++;
+    }
+    ~ExportState() {
+        activeExports--;
+    }
+};
+
+size_t formatExportRow(char *out, size_t size, bool csv, const LogEntry &entry) {
+    const HistoryPoint &p = entry.reading;
+    if (csv) {
+        int temperature = abs(p.temperature);
+        return snprintf_P(out, size, PSTR("%lu,%S,%d.%d,%s%d.%d,%d\n"),
+                          (unsigned long)entry.time, LOG_TYPE_NAMES[entry.type],
+                          p.moisture / 10, p.moisture % 10,
+                          p.temperature < 0 ? "-" : "", temperature / 10, temperature % 10,
+                          p.humidity / 10);
+    }
+    JsonWriter json(out, size);
+    json.integer(KEY_TIME, entry.time);
+    json.text(KEY_TYPE, LOG_TYPE_NAMES[entry.type]);
+    json.fixed(KEY_MOISTURE, p.moisture, 1);
+    json.fixed(KEY_TEMPERATURE, p.temperature, 1);
+    json.integer(KEY_HUMIDITY, p.humidity / 10);
+    if (!json.finish() || json.length() + 1 >= size) {
+        return 0;
+    }
+    size_t len = json.length();
+    out[len++] = '\n';
+    return len;
+}
+
+// GET /api/export?from=<log time>&to=<log time>&format=csv|ndjson
+// Streams logged records from flash, then those not yet written, one page
+// of the log in RAM per export and at most MAX_EXPORTS exports at a time.
+// A reset loses the unwritten records, at most LOG_FLUSH_AGE of them.
+void handleExport(AsyncWebServerRequest *request) {
+    HEAP_SCOPE(heapMetrics, HEAP_EXPORT);
+    if (activeExports >= MAX_EXPORTS) {
+        request->send(503);
+        return;
+    }
+    bool csv = !request->hasParam("format") || request->getParam("format")->value() == "csv";
+    if (!csv && request->getParam("format")->value() != "ndjson") {
+        request->send(400);
+        return;
+    }
+    long from = request->hasParam("from") ? request->getParam("from")->value().toInt() : 0;
+    long to = request->hasParam("to") ? request->getParam("to")->value().toInt()
+                                      : (long)telemetryLog.now(uptimeSeconds);
+    if (from < 0 || to < 0) {
+        request->send(400);
+        return;
+    }
     
-    // Read temperature and humidity
-    float newTemp = dht.readTemperature();
-    float newHum = dht.readHumidity();
+    std::shared_ptr<ExportState> exportState = std::make_shared<ExportState>();
+    exportState->to = to;
+    exportState->csv = csv;
+    if (!exportState->cursor.seek(from)) {
+        exportState->started = true;  // Nothing stored yet: empty body
+    }
     
-    if (!isnan(newTemp) && !isnan(newHum)) {
-        temperature = newTemp;
-        humidity = newHum;
-        sensorError = false;
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        csv ? "text/csv" : "application/x-ndjson",
+        [exportState](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            char *out = (char *)buffer;
+            size_t len = 0;
+            if (maxLen < EXPORT_ROW_MAX) {
+                return RESPONSE_TRY_AGAIN;
+            }
+            if (!exportState->started) {
+                if (exportState->csv) {
+                    len = strlcpy_P(out, PSTR("time,type,moisture,temperature,humidity\n"), maxLen);
+                }
+                exportState->started = true;
+            }
+            while (maxLen - len >= EXPORT_ROW_MAX) {
+                if (!exportState->pending) {
+                    if (!exportState->cursor.next(exportState->entry) || exportState->entry.time > exportState->to) {
+                        break;
+                    }
+                    exportState->pending = true;
+                }
+                size_t row = formatExportRow(out + len, maxLen - len, exportState->csv, exportState->entry);
+                if (row == 0) {
+                    break;
+                }
+                len += row;
+                exportState->pending = false;
+            }
+            return len;
+        });
+    request->send(response);
+}
+
+// Pump state changes from the controller (auto mode, timeout, /api/control)
+void onPumpChanged(bool active) {
+    power.setBusy(active);
+    if (active) {
+        scheduler.wakeAt(TASK_PUMP_TIMEOUT, controller.pumpDeadline());
+        scheduler.wake(TASK_SENSORS, millis());  // back to the fast sampling rate
     } else {
-        sensorError = true;
-        Serial.println("DHT sensor error");
-    }
-    
-    // Debug output
-    Serial.printf("Raw ADC: %d, Voltage: %.2fV\n", rawValue, voltage);
-    Serial.printf("Moisture: %.1f%%, Temp: %.1f°C, Humidity: %.1f%%\n", 
-                 soilMoisture, temperature, humidity);
-}
-
-String getSensorJson() {
-    String json = "{";
-    json += "\"soil_moisture\":" + String(soilMoisture, 1) + ",";
-    json += "\"temperature\":" + String(temperature, 1) + ",";
-    json += "\"humidity\":" + String(humidity, 1) + ",";
-    json += "\"pump_active\":" + String(pumpActive ? "true" : "false") + ",";
-    json += "\"auto_mode\":" + String(autoMode ? "true" : "false") + ",";
-    json += "\"sensor_error\":" + String(sensorError ? "true" : "false");
-    json += "}";
-    return json;
-}
-
-void startPump() {
-    digitalWrite(PUMP_RELAY_PIN, RELAY_ACTIVE_LOW ? LOW : HIGH);
-    pumpActive = true;
-    pumpStartTime = millis();
-    Serial.println("Pump started");
-    events.send("pump_on", "pump", millis());
-}
-
-void stopPump() {
-    digitalWrite(PUMP_RELAY_PIN, RELAY_ACTIVE_LOW ? HIGH : LOW);
-    pumpActive = false;
-    lastPumpStop = millis();
-    Serial.println("Pump stopped");
-    events.send("pump_off", "pump", millis());
-} 
\ No newline at end of file
+        scheduler.cancel(TASK_PUMP_TIMEOUT);
+        scheduler.wake(TASK_AUTO_MODE, millis(), controller.config.pumpCooldown);
+    }
+    telemetryLog.record(uptimeSeconds, active ? LOG_PUMP_ON : LOG_PUMP_OFF, currentReading());
+    scheduler.wake(TASK_TELEMETRY, millis());
+    LOG_INFO(logger, MODULE_PUMP, "%S", active ? PSTR("Pump started") : PSTR("Pump stopped"));
+    events.send(active ? "pump_on" : "pump_off", "pump", millis());
+}
\ No newline at end of file
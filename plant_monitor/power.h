@@ -0,0 +1,153 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdio.h>
+#include "hal.h"
+#include "config.h"
+
+// Profiles map onto the radio sleep mode used while idle
+enum PowerProfile : uint8_t {
+    POWER_FULL = HAL_SLEEP_NONE,
+    POWER_MODEM_SLEEP = HAL_SLEEP_MODEM,
+    POWER_LIGHT_SLEEP = HAL_SLEEP_LIGHT,
+    POWER_PROFILE_COUNT
+};
+
+enum PowerState : uint8_t {
+    POWER_STATE_ACTIVE,
+    POWER_STATE_MODEM_SLEEP,
+    POWER_STATE_LIGHT_SLEEP,
+    POWER_STATE_COUNT
+};
+
+// Sleeps between scheduler deadlines and estimates the average current.
+//
+// idle() is called at the end of every loop() with the next deadline. In a
+// low-power profile it selects the profile's radio sleep mode and idles
+// until the deadline; otherwise it returns at once and the loop keeps
+// spinning at full power. Time between idle() calls counts as active, time
+// spent idling counts against the profile's sleep state, and the average
+// current is the time-weighted POWER_CURRENT_*_UA. How late each sleep
+// returns past its deadline is tracked as the wake latency.
+class PowerManager {
+public:
+    void begin(uint8_t profile) {
+        _profile = profile < POWER_PROFILE_COUNT ? profile : (uint8_t)POWER_FULL;
+        _lastMicros = halMicros();
+    }
+
+    void setProfile(uint8_t profile) {
+        if (profile < POWER_PROFILE_COUNT) {
+            _profile = profile;
+        }
+    }
+
+    uint8_t profile() const { return _profile; }
+
+    // An incoming connection: full power for POWER_AWAKE_HOLD
+    void activity(unsigned long now) {
+        _awakeUntil = now + POWER_AWAKE_HOLD;
+        _held = true;
+    }
+
+    // Full power while busy (pump running)
+    void setBusy(bool busy) { _busy = busy; }
+
+    bool lowPower(unsigned long now) const {
+        if (_profile == POWER_FULL || _busy) {
+            return false;
+        }
+        return !_held || (long)(now - _awakeUntil) >= 0;
+    }
+
+    void idle(unsigned long now, unsigned long deadline) {
+        unsigned long start = halMicros();
+        account(POWER_STATE_ACTIVE, start - _lastMicros);
+        _lastMicros = start;
+
+        bool low = lowPower(now);
+        uint8_t mode = low ? _profile : (uint8_t)POWER_FULL;
+        if (mode != _mode) {
+            halSleepMode(mode, POWER_LISTEN_INTERVAL);
+            _mode = mode;
+        }
+        long wait = (long)(deadline - now);
+        if (!low || wait < POWER_MIN_IDLE) {
+            return;
+        }
+
+        halIdle(wait);
+        unsigned long end = halMicros();
+        account(_profile == POWER_LIGHT_SLEEP ? POWER_STATE_LIGHT_SLEEP : POWER_STATE_MODEM_SLEEP,
+                end - start);
+        _lastMicros = end;
+        _sleeps++;
+        long late = (long)(halMillis() - deadline);
+        if (late > 0) {
+            _wakeLateTotal += late;
+            if ((unsigned long)late > _wakeLateMax) _wakeLateMax = late;
+        }
+    }
+
+    // Time-weighted average of the per-state currents since boot
+    uint32_t averageMicroamps() const {
+        static const uint32_t currents[POWER_STATE_COUNT] = {
+            POWER_CURRENT_ACTIVE_UA, POWER_CURRENT_MODEM_UA, POWER_CURRENT_LIGHT_UA
+        };
+        uint64_t total = 0;
+        double charge = 0;
+        for (uint8_t s = 0; s < POWER_STATE_COUNT; s++) {
+            total += _micros[s];
+            charge += (double)_micros[s] * currents[s];
+        }
+        return total ? (uint32_t)(charge / total) : currents[POWER_STATE_ACTIVE];
+    }
+
+    uint64_t stateMicros(uint8_t s) const { return _micros[s]; }
+    uint32_t sleeps() const { return _sleeps; }
+    uint32_t wakeLateMax() const { return _wakeLateMax; }
+    uint32_t wakeLateAverage() const { return _sleeps ? _wakeLateTotal / _sleeps : 0; }
+
+    static constexpr uint16_t lineCount() { return 2 + (1 + POWER_STATE_COUNT) + 2 * 4; }
+
+    // Prometheus lines for /api/metrics; 0 past the end
+    size_t formatLine(uint16_t n, char *out, size_t size) const {
+        static const char *const states[POWER_STATE_COUNT] = {"active", "modem_sleep", "light_sleep"};
+        if (n == 0) return snprintf(out, size, "# TYPE power_profile gauge\n");
+        if (n == 1) return snprintf(out, size, "power_profile %u\n", _profile);
+        n -= 2;
+        if (n == 0) return snprintf(out, size, "# TYPE power_state_seconds_total counter\n");
+        if (n <= POWER_STATE_COUNT) {
+            return snprintf(out, size, "power_state_seconds_total{state=\"%s\"} %.3f\n",
+                            states[n - 1], _micros[n - 1] * 1e-6);
+        }
+        n -= 1 + POWER_STATE_COUNT;
+        switch (n) {
+            case 0: return snprintf(out, size, "# TYPE power_current_estimate_milliamps gauge\n");
+            case 1: return snprintf(out, size, "power_current_estimate_milliamps %.2f\n", averageMicroamps() * 1e-3);
+            case 2: return snprintf(out, size, "# TYPE power_sleeps_total counter\n");
+            case 3: return snprintf(out, size, "power_sleeps_total %lu\n", (unsigned long)_sleeps);
+            case 4: return snprintf(out, size, "# TYPE power_wake_late_max_seconds gauge\n");
+            case 5: return snprintf(out, size, "power_wake_late_max_seconds %.3f\n", _wakeLateMax * 1e-3);
+            case 6: return snprintf(out, size, "# TYPE power_wake_late_avg_seconds gauge\n");
+            case 7: return snprintf(out, size, "power_wake_late_avg_seconds %.3f\n", wakeLateAverage() * 1e-3);
+        }
+        return 0;
+    }
+
+private:
+    void account(uint8_t s, unsigned long micros) { _micros[s] += micros; }
+
+    uint8_t _profile = POWER_FULL;
+    uint8_t _mode = POWER_FULL;
+    bool _busy = false;
+    bool _held = false;
+    unsigned long _awakeUntil = 0;
+    unsigned long _lastMicros = 0;
+    uint64_t _micros[POWER_STATE_COUNT] = {};
+    uint32_t _sleeps = 0;
+    uint32_t _wakeLateMax = 0;
+    uint32_t _wakeLateTotal = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,254 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+inline uint32_t schedMicros() { return micros(); }
+#else
+#include "hal.h"
+#ifndef strlcpy_P
+#define strlcpy_P(dst, src, size) snprintf(dst, size, "%s", src)
+#endif
+inline uint32_t schedMicros() { return halMicros(); }
+#endif
+
+#define SCHED_MAX_TASKS 16
+#define SCHED_WHEEL_SLOTS 64         // 1 ms per slot
+#define SCHED_NEVER 0xFFFFFFFFUL     // Task return value: wait for wake()
+#ifndef SCHED_PASS_BUDGET
+#define SCHED_PASS_BUDGET 5000       // us per run() before non-critical tasks wait
+#endif
+
+// Returns the delay in ms until the task should run again (0 = next pass)
+// or SCHED_NEVER to sleep until woken
+typedef uint32_t (*SchedTaskFn)(uint32_t now);
+
+struct SchedTaskStats {
+    uint32_t runs;
+    uint32_t overruns;       // runs longer than the task's budget
+    uint32_t deferred;       // passes skipped because the pass budget was spent
+    uint32_t maxMicros;
+    uint32_t maxLateMillis;  // start time minus deadline
+};
+
+// Cooperative deadline scheduler on a hashed timer wheel.
+//
+// Tasks are registered highest priority first. run() moves the wheel up to
+// now, collecting tasks whose deadline has passed, then runs them in
+// priority order. A pass that has used SCHED_PASS_BUDGET leaves the
+// remaining non-critical tasks ready for the next pass, so a slow task
+// delays other work by at most one task and critical tasks by nothing
+// queued behind it. Deadlines are wrap-safe millis() values; the wheel
+// slot is deadline % SCHED_WHEEL_SLOTS and later laps stay in the slot.
+class Scheduler {
+public:
+    // Task names are PROGMEM strings. Returns the task id.
+    uint8_t add(const char *name, SchedTaskFn fn, uint32_t budgetMicros, bool critical = false) {
+        uint8_t id = _count++;
+        Task &t = _tasks[id];
+        t.name = name;
+        t.fn = fn;
+        t.budgetMicros = budgetMicros;
+        t.critical = critical;
+        t.armed = false;
+        return id;
+    }
+
+    // Schedules the task at time (replacing any earlier schedule)
+    void wakeAt(uint8_t id, uint32_t time) {
+        cancel(id);
+        Task &t = _tasks[id];
+        t.deadline = time;
+        t.armed = true;
+        if ((int32_t)(time - _lastTick) <= 0) {
+            _ready |= taskMask(id);
+        } else {
+            _slots[time % SCHED_WHEEL_SLOTS] |= taskMask(id);
+        }
+    }
+
+    void wake(uint8_t id, uint32_t now, uint32_t delay = 0) {
+        wakeAt(id, now + delay);
+    }
+
+    void cancel(uint8_t id) {
+        Task &t = _tasks[id];
+        if (t.armed) {
+            _slots[t.deadline % SCHED_WHEEL_SLOTS] &= ~taskMask(id);
+            _ready &= ~taskMask(id);
+            t.armed = false;
+        }
+    }
+
+    void begin(uint32_t now) {
+        _lastTick = now;
+    }
+
+    // One scheduling pass; call from every loop()
+    void run(uint32_t now) {
+        uint32_t passStart = schedMicros();
+        advance(now);
+
+        uint16_t pending = _ready;
+        while (pending) {
+            uint8_t id = __builtin_ctz(pending);
+            pending &= pending - 1;
+            if (!(_ready & taskMask(id))) {
+                continue;  // rescheduled by a task earlier in this pass
+            }
+            Task &t = _tasks[id];
+            if (!t.critical && schedMicros() - passStart >= SCHED_PASS_BUDGET) {
+                t.stats.deferred++;
+                continue;
+            }
+            _ready &= ~taskMask(id);
+            t.armed = false;
+
+            uint32_t late = now - t.deadline;
+            if ((int32_t)late > 0 && late > t.stats.maxLateMillis) {
+                t.stats.maxLateMillis = late;
+            }
+            uint32_t start = schedMicros();
+            uint32_t delay = t.fn(now);
+            uint32_t elapsed = schedMicros() - start;
+
+            t.stats.runs++;
+            if (elapsed > t.stats.maxMicros) t.stats.maxMicros = elapsed;
+            if (elapsed > t.budgetMicros) t.stats.overruns++;
+            if (delay != SCHED_NEVER && !t.armed) {
+                wakeAt(id, now + delay);
+            }
+        }
+        uint32_t overhead = schedMicros() - passStart;
+        _passes++;
+        if (overhead > _maxPassMicros) _maxPassMicros = overhead;
+    }
+
+    // Earliest deadline of any armed task, or now if something is ready
+    // (for the host simulator and idle sleep)
+    uint32_t nextDeadline(uint32_t now) const {
+        if (_ready) {
+            return now;
+        }
+        // Compare offsets from now: an overdue deadline is a negative offset,
+        // not a time half the clock range away
+        uint32_t wait = SCHED_NEVER / 2;
+        for (uint8_t id = 0; id < _count; id++) {
+            const Task &t = _tasks[id];
+            if (!t.armed) {
+                continue;
+            }
+            int32_t offset = (int32_t)(t.deadline - now);
+            if (offset <= 0) {
+                return now;
+            }
+            if ((uint32_t)offset < wait) {
+                wait = offset;
+            }
+        }
+        return now + wait;
+    }
+
+    uint8_t count() const { return _count; }
+    const SchedTaskStats &stats(uint8_t id) const { return _tasks[id].stats; }
+    uint32_t passes() const { return _passes; }
+    uint32_t maxPassMicros() const { return _maxPassMicros; }
+
+    uint16_t lineCount() const {
+        return 4 * (1 + _count) + 2;
+    }
+
+    // Prometheus lines for /api/metrics; 0 past the end
+    size_t formatLine(uint16_t n, char *out, size_t size) const {
+        static const char *const families[] = {
+            "sched_task_runs_total", "sched_task_overruns_total",
+            "sched_task_max_seconds", "sched_task_max_late_seconds"
+        };
+        uint8_t family = n / (1 + _count);
+        uint8_t line = n % (1 + _count);
+        if (family < 4) {
+            if (line == 0) {
+                return snprintf(out, size, "# TYPE %s %s\n", families[family],
+                                family < 2 ? "counter" : "gauge");
+            }
+            const SchedTaskStats &s = _tasks[line - 1].stats;
+            char name[24];
+            strlcpy_P(name, _tasks[line - 1].name, sizeof(name));
+            if (family < 2) {
+                return snprintf(out, size, "%s{task=\"%s\"} %lu\n", families[family], name,
+                                (unsigned long)(family == 0 ? s.runs : s.overruns));
+            }
+            return snprintf(out, size, "%s{task=\"%s\"} %.6f\n", families[family], name,
+                            family == 2 ? s.maxMicros * 1e-6 : s.maxLateMillis * 1e-3);
+        }
+        n -= 4 * (1 + _count);
+        if (n == 0) {
+            return snprintf(out, size, "# TYPE sched_pass_max_seconds gauge\n");
+        }
+        if (n == 1) {
+            return snprintf(out, size, "sched_pass_max_seconds %.6f\n", _maxPassMicros * 1e-6);
+        }
+        return 0;
+    }
+
+    // One human-readable line per task for the serial console
+    size_t formatSummary(uint8_t id, char *out, size_t size) const {
+        const SchedTaskStats &s = _tasks[id].stats;
+        char name[24];
+        strlcpy_P(name, _tasks[id].name, sizeof(name));
+        return snprintf(out, size, "%-14s runs=%lu max=%luus over=%lu late=%lums deferred=%lu\n",
+                        name, (unsigned long)s.runs, (unsigned long)s.maxMicros,
+                        (unsigned long)s.overruns, (unsigned long)s.maxLateMillis,
+                        (unsigned long)s.deferred);
+    }
+
+private:
+    struct Task {
+        const char *name;
+        SchedTaskFn fn;
+        uint32_t budgetMicros;
+        uint32_t deadline;
+        bool critical;
+        bool armed;
+        SchedTaskStats stats;
+    };
+
+    static uint16_t taskMask(uint8_t id) { return (uint16_t)1 << id; }
+
+    // Moves due tasks from the wheel to the ready set. A gap of a full lap
+    // or more (a long blocking call) checks every slot once.
+    void advance(uint32_t now) {
+        uint32_t ticks = now - _lastTick;
+        if (ticks > SCHED_WHEEL_SLOTS) {
+            ticks = SCHED_WHEEL_SLOTS;
+        }
+        for (uint32_t i = 1; i <= ticks; i++) {
+            uint8_t slot = (_lastTick + i) % SCHED_WHEEL_SLOTS;
+            uint16_t mask = _slots[slot];
+            while (mask) {
+                uint8_t id = __builtin_ctz(mask);
+                mask &= mask - 1;
+                if ((int32_t)(now - _tasks[id].deadline) >= 0) {
+                    _slots[slot] &= ~taskMask(id);
+                    _ready |= taskMask(id);
+                }
+            }
+        }
+        _lastTick = now;
+    }
+
+    Task _tasks[SCHED_MAX_TASKS];
+    uint8_t _count = 0;
+    uint16_t _slots[SCHED_WHEEL_SLOTS] = {};
+    uint16_t _ready = 0;
+    uint32_t _lastTick = 0;
+    uint32_t _passes = 0;
+    uint32_t _maxPassMicros = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,474 @@
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "history.h"
+
+// Append-only telemetry log on LittleFS.
+//
+// Records are 32 bits: a packReading() payload in bits 0-23, the record type
+// in bits 24-27 and the seconds since the previous record in bits 28-31.
+// They are collected in a RAM page and written as whole LOG_PAGE_SIZE pages
+// to segment files /log/<id>, LOG_SEGMENT_PAGES pages each. Every page
+// starts with the time of its first record, so a segment's page headers are
+// its time index: a range query picks the segment from the in-RAM segment
+// index, then binary-searches the page headers. The oldest segment is
+// deleted when the segment count or free space runs out.
+//
+// A page is written when it is full or once its first record is
+// LOG_FLUSH_AGE old, whichever comes first, so a reset loses at most that
+// much of the log however slowly readings arrive. Readers see the RAM page
+// after the last stored one.
+//
+// Log time is in seconds and continues from the last logged record after a
+// reboot (downtime is not counted); a LOG_BOOT record marks each restart.
+
+#define LOG_DIR "/log"
+#define LOG_PAGE_SIZE 256
+#define LOG_PAGE_HEADER 8
+#define LOG_PAGE_RECORDS ((LOG_PAGE_SIZE - LOG_PAGE_HEADER) / 4)
+#define LOG_SEGMENT_PAGES 128     // 32 KB per segment file
+#define LOG_MAX_SEGMENTS 96       // ~3 MB, a week of 1 Hz samples
+#define LOG_PAGE_VERSION 1
+#define LOG_FLUSH_AGE 300         // s a record may wait in the RAM page
+#define LOG_FLUSH_NONE UINT32_MAX // flushWait() with nothing waiting
+
+enum LogRecordType : uint8_t {
+    LOG_SENSOR = 0,     // Periodic reading
+    LOG_SENSOR_ERROR,   // Reading with a failed DHT transfer
+    LOG_PUMP_ON,
+    LOG_PUMP_OFF,
+    LOG_BOOT,
+    LOG_TIME            // Payload advances the clock for gaps over 15s (not returned)
+};
+
+struct LogEntry {
+    uint32_t time;
+    LogRecordType type;
+    HistoryPoint reading;
+};
+
+struct LogPageHeader {
+    uint32_t baseTime;
+    uint16_t count;
+    uint8_t version;
+    uint8_t reserved;
+};
+
+struct LogSegment {
+    uint32_t id;
+    uint32_t start;  // time of the first record
+};
+
+// Walks the records of one page; shared by the writer (on resume) and cursor
+struct LogPageReader {
+    const uint8_t *page;
+    uint16_t index;
+    uint32_t time;
+
+    void reset(const uint8_t *data) {
+        page = data;
+        index = 0;
+        time = header().baseTime;
+    }
+
+    const LogPageHeader &header() const {
+        return *(const LogPageHeader *)page;
+    }
+
+    bool next(LogEntry &entry) {
+        const LogPageHeader &h = header();
+        while (index < h.count && index < LOG_PAGE_RECORDS) {
+            const uint8_t *r = page + LOG_PAGE_HEADER + index++ * 4;
+            uint32_t record = r[0] | ((uint32_t)r[1] << 8) | ((uint32_t)r[2] << 16) | ((uint32_t)r[3] << 24);
+            time += record >> 28;
+            uint8_t type = (record >> 24) & 0x0F;
+            if (type == LOG_TIME) {
+                time += record & 0xFFFFFF;
+                continue;
+            }
+            if (type > LOG_BOOT) {
+                continue;  // Unknown type from a newer format
+            }
+            entry.time = time;
+            entry.type = (LogRecordType)type;
+            entry.reading = unpackReading(record & 0xFFFFFF);
+            return true;
+        }
+        return false;
+    }
+};
+
+inline void logSegmentPath(char *path, uint32_t id) {
+    snprintf(path, 24, LOG_DIR "/%08lx", (unsigned long)id);
+}
+
+class TelemetryLog {
+public:
+    // Mounts the filesystem, indexes the segments and resumes the log clock
+    bool begin(uint32_t uptime) {
+        if (!LittleFS.begin()) {
+            return false;
+        }
+        LittleFS.mkdir(LOG_DIR);
+
+        // Index the newest LOG_MAX_SEGMENTS segments, then delete the rest
+        // and any without a complete first page
+        _segmentCount = 0;
+        bool stray = false;
+        Dir dir = LittleFS.openDir(LOG_DIR);
+        while (dir.next()) {
+            uint32_t id = strtoul(dir.fileName().c_str(), nullptr, 16);
+            LogPageHeader header;
+            File f = dir.openFile("r");
+            bool valid = f.size() >= LOG_PAGE_SIZE &&
+                         f.read((uint8_t *)&header, sizeof(header)) == sizeof(header);
+            f.close();
+            if (!valid || (_segmentCount >= LOG_MAX_SEGMENTS && id < _segments[0].id)) {
+                stray = true;
+                continue;
+            }
+            if (_segmentCount >= LOG_MAX_SEGMENTS) {
+                memmove(_segments, _segments + 1, (_segmentCount - 1) * sizeof(LogSegment));
+                _segmentCount--;
+                stray = true;
+            }
+            insertSegment(id, header.baseTime);
+        }
+        while (stray) {
+            stray = removeStraySegment();
+        }
+
+        // Resume after the last record of the newest segment
+        uint32_t lastTime = 0;
+        if (_segmentCount > 0) {
+            char path[24];
+            logSegmentPath(path, _segments[_segmentCount - 1].id);
+            File f = LittleFS.open(path, "r");
+            _segmentPages = f.size() / LOG_PAGE_SIZE;
+            if (_segmentPages > 0 && f.seek((_segmentPages - 1) * LOG_PAGE_SIZE) &&
+                f.read(_page, LOG_PAGE_SIZE) == LOG_PAGE_SIZE) {
+                LogPageReader reader;
+                LogEntry entry;
+                reader.reset(_page);
+                while (reader.next(entry)) {
+                    lastTime = entry.time;
+                }
+                lastTime = max(lastTime, reader.time);
+            }
+            f.close();
+        }
+        _clockBase = lastTime + 1 - uptime;
+        _pageCount = 0;
+        _ready = true;
+        return true;
+    }
+
+    uint32_t now(uint32_t uptime) const { return _clockBase + uptime; }
+
+    void record(uint32_t uptime, LogRecordType type, const HistoryPoint &reading) {
+        if (_ready) {
+            append(now(uptime), type, packReading(reading));
+        }
+    }
+
+    // Seconds until the RAM page is due to be written; LOG_FLUSH_NONE if
+    // it holds nothing
+    uint32_t flushWait(uint32_t uptime) const {
+        if (_pageCount == 0) {
+            return LOG_FLUSH_NONE;
+        }
+        uint32_t age = now(uptime) - ((const LogPageHeader *)_page)->baseTime;
+        return age < LOG_FLUSH_AGE ? LOG_FLUSH_AGE - age : 0;
+    }
+
+    // Writes the RAM page if its first record is LOG_FLUSH_AGE old
+    void flushStale(uint32_t uptime) {
+        if (_ready && flushWait(uptime) == 0) {
+            flushPage();
+        }
+    }
+
+    // Segment index, oldest first
+    uint8_t segmentCount() const { return _segmentCount; }
+    const LogSegment &segment(uint8_t index) const { return _segments[index]; }
+
+    uint16_t pageRecords() const { return _pageCount; }  // waiting in RAM
+
+    // Copies the RAM page, header count filled in; false if it is empty
+    bool copyPage(uint8_t *page) const {
+        if (_pageCount == 0) {
+            return false;
+        }
+        memcpy(page, _page, LOG_PAGE_HEADER + _pageCount * 4);
+        ((LogPageHeader *)page)->count = _pageCount;
+        return true;
+    }
+    uint32_t pagesWritten() const { return _pagesWritten; }
+    uint32_t segmentsDropped() const { return _segmentsDropped; }
+    unsigned long flushMaxMicros() const { return _flushMaxMicros; }
+
+    static constexpr uint16_t lineCount() { return 10; }
+
+    // Prometheus lines for /api/metrics; 0 past the end
+    size_t formatLine(uint16_t n, char *out, size_t size) const {
+        switch (n) {
+            case 0: return snprintf(out, size, "# TYPE telemetry_pages_written_total counter\n");
+            case 1: return snprintf(out, size, "telemetry_pages_written_total %lu\n", (unsigned long)_pagesWritten);
+            case 2: return snprintf(out, size, "# TYPE telemetry_segments_dropped_total counter\n");
+            case 3: return snprintf(out, size, "telemetry_segments_dropped_total %lu\n", (unsigned long)_segmentsDropped);
+            case 4: return snprintf(out, size, "# TYPE telemetry_segments gauge\n");
+            case 5: return snprintf(out, size, "telemetry_segments %u\n", _segmentCount);
+            case 6: return snprintf(out, size, "# TYPE telemetry_page_records gauge\n");
+            case 7: return snprintf(out, size, "telemetry_page_records %u\n", _pageCount);
+            case 8: return snprintf(out, size, "# TYPE telemetry_flush_max_seconds gauge\n");
+            case 9: return snprintf(out, size, "telemetry_flush_max_seconds %.6f\n", _flushMaxMicros * 1e-6);
+            default: return 0;
+        }
+    }
+
+private:
+    void insertSegment(uint32_t id, uint32_t start) {
+        // Directory order is not guaranteed; keep the index sorted by id
+        uint8_t i = _segmentCount++;
+        while (i > 0 && _segments[i - 1].id > id) {
+            _segments[i] = _segments[i - 1];
+            i--;
+        }
+        _segments[i] = {id, start};
+    }
+
+    void append(uint32_t time, uint8_t type, uint32_t payload) {
+        if (_pageCount > 0) {
+            uint32_t gap = time - _lastTime;
+            if (time < _lastTime || gap > 0xFFFFFF ||
+                (gap > 15 && _pageCount + 2 > LOG_PAGE_RECORDS)) {
+                flushPage();
+            } else if (gap > 15) {
+                putRecord(0, LOG_TIME, gap);
+                _lastTime = time;
+            }
+        }
+        if (_pageCount == 0) {
+            LogPageHeader *header = (LogPageHeader *)_page;
+            header->baseTime = time;
+            header->version = LOG_PAGE_VERSION;
+            header->reserved = 0;
+            _lastTime = time;
+        }
+        putRecord(time - _lastTime, type, payload);
+        _lastTime = time;
+        if (_pageCount >= LOG_PAGE_RECORDS ||
+            time - ((LogPageHeader *)_page)->baseTime >= LOG_FLUSH_AGE) {
+            flushPage();
+        }
+    }
+
+    void putRecord(uint32_t delta, uint8_t type, uint32_t payload) {
+        uint32_t record = (delta << 28) | ((uint32_t)type << 24) | (payload & 0xFFFFFF);
+        uint8_t *r = _page + LOG_PAGE_HEADER + _pageCount * 4;
+        r[0] = record;
+        r[1] = record >> 8;
+        r[2] = record >> 16;
+        r[3] = record >> 24;
+        _pageCount++;
+    }
+
+    // Writes the RAM page as one whole page at the end of the newest segment
+    void flushPage() {
+        unsigned long start = micros();
+        LogPageHeader *header = (LogPageHeader *)_page;
+        header->count = _pageCount;
+        memset(_page + LOG_PAGE_HEADER + _pageCount * 4, 0xFF, (LOG_PAGE_RECORDS - _pageCount) * 4);
+
+        if (_segmentCount == 0 || _segmentPages >= LOG_SEGMENT_PAGES) {
+            startSegment(header->baseTime);
+        }
+
+        char path[24];
+        logSegmentPath(path, _segments[_segmentCount - 1].id);
+        File f = LittleFS.open(path, "a");
+        if (f) {
+            f.write(_page, LOG_PAGE_SIZE);
+            f.close();
+            _segmentPages++;
+            _pagesWritten++;
+        }
+        _pageCount = 0;
+
+        unsigned long elapsed = micros() - start;
+        if (elapsed > _flushMaxMicros) {
+            _flushMaxMicros = elapsed;
+        }
+    }
+
+    void startSegment(uint32_t start) {
+        FSInfo info;
+        LittleFS.info(info);
+        while (_segmentCount > 0 &&
+               (_segmentCount >= LOG_MAX_SEGMENTS ||
+                info.totalBytes - info.usedBytes < 2UL * LOG_SEGMENT_PAGES * LOG_PAGE_SIZE)) {
+            dropOldestSegment();
+            LittleFS.info(info);
+        }
+        uint32_t id = _segmentCount > 0 ? _segments[_segmentCount - 1].id + 1 : 0;
+        _segments[_segmentCount++] = {id, start};
+        _segmentPages = 0;
+    }
+
+    // Deletes one file in LOG_DIR that is not in the index; false if none
+    // is left. The directory is listed again after each removal.
+    bool removeStraySegment() {
+        char path[24];
+        bool found = false;
+        Dir dir = LittleFS.openDir(LOG_DIR);
+        while (!found && dir.next()) {
+            uint32_t id = strtoul(dir.fileName().c_str(), nullptr, 16);
+            found = true;
+            for (uint8_t i = 0; i < _segmentCount; i++) {
+                if (_segments[i].id == id) {
+                    found = false;
+                    break;
+                }
+            }
+            if (found) {
+                logSegmentPath(path, id);
+            }
+        }
+        if (found) {
+            LittleFS.remove(path);
+            _segmentsDropped++;
+        }
+        return found;
+    }
+
+    void dropOldestSegment() {
+        char path[24];
+        logSegmentPath(path, _segments[0].id);
+        LittleFS.remove(path);
+        memmove(_segments, _segments + 1, (_segmentCount - 1) * sizeof(LogSegment));
+        _segmentCount--;
+        _segmentsDropped++;
+    }
+
+    alignas(4) uint8_t _page[LOG_PAGE_SIZE];
+    uint16_t _pageCount = 0;
+    uint32_t _lastTime = 0;
+    uint32_t _clockBase = 0;
+    bool _ready = false;
+
+    LogSegment _segments[LOG_MAX_SEGMENTS];
+    uint8_t _segmentCount = 0;
+    uint16_t _segmentPages = 0;  // pages in the newest segment
+
+    uint32_t _pagesWritten = 0;
+    uint32_t _segmentsDropped = 0;
+    unsigned long _flushMaxMicros = 0;
+};
+
+// Reads records in time order starting at a given time, one page in RAM.
+// The writer's unflushed page comes last; if it is written out while the
+// cursor is still in the files, the cursor reads it from there instead.
+class LogCursor {
+public:
+    explicit LogCursor(const TelemetryLog &log) : _log(log) {}
+
+    ~LogCursor() {
+        if (_file) _file.close();
+    }
+
+    // Positions the cursor at the first record at or after from
+    bool seek(uint32_t from) {
+        _from = from;
+        uint8_t index = 0;
+        for (uint8_t i = 1; i < _log.segmentCount(); i++) {
+            if (_log.segment(i).start <= from) index = i;
+        }
+        if (_log.segmentCount() == 0 || !openSegment(_log.segment(index).id)) {
+            return loadUnflushed();
+        }
+
+        // Binary search for the last page that starts at or before from
+        uint32_t pages = _file.size() / LOG_PAGE_SIZE;
+        uint32_t low = 0;
+        uint32_t high = pages;
+        while (high - low > 1) {
+            uint32_t mid = (low + high) / 2;
+            LogPageHeader header;
+            _file.seek(mid * LOG_PAGE_SIZE);
+            _file.read((uint8_t *)&header, sizeof(header));
+            if (header.baseTime <= from) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        _file.seek(low * LOG_PAGE_SIZE);
+        return loadPage() || loadUnflushed();
+    }
+
+    bool next(LogEntry &entry) {
+        while (_loaded) {
+            if (_reader.next(entry)) {
+                if (entry.time >= _from) return true;
+                continue;
+            }
+            if (_unflushed ||
+                (!loadPage() && !(nextSegment() && loadPage()) && !loadUnflushed())) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+private:
+    bool openSegment(uint32_t id) {
+        char path[24];
+        logSegmentPath(path, id);
+        if (_file) _file.close();
+        _file = LittleFS.open(path, "r");
+        _segmentId = id;
+        return (bool)_file;
+    }
+
+    // Opens the segment after the current one (rotation may have removed some)
+    bool nextSegment() {
+        for (uint8_t i = 0; i < _log.segmentCount(); i++) {
+            if (_log.segment(i).id > _segmentId) {
+                return openSegment(_log.segment(i).id);
+            }
+        }
+        return false;
+    }
+
+    bool loadPage() {
+        _loaded = _file && _file.read(_page, LOG_PAGE_SIZE) == LOG_PAGE_SIZE;
+        if (_loaded) {
+            _reader.reset(_page);
+        }
+        return _loaded;
+    }
+
+    // The last page: nothing is read after it
+    bool loadUnflushed() {
+        if (_file) _file.close();
+        _loaded = _log.copyPage(_page);
+        _unflushed = true;
+        if (_loaded) {
+            _reader.reset(_page);
+        }
+        return _loaded;
+    }
+
+    const TelemetryLog &_log;
+    File _file;
+    uint32_t _segmentId = 0;
+    uint32_t _from = 0;
+    alignas(4) uint8_t _page[LOG_PAGE_SIZE];
+    LogPageReader _reader;
+    bool _loaded = false;
+    bool _unflushed = false;  // _page is the writer's RAM page
+};
+
+#endif
\ No newline at end of file
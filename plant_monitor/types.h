@@ -2,15 +2,36 @@
 #define TYPES_H
 
 #include <stdint.h>  // For uint8_t type
+#include "config.h"
+#include "moisture_lut.h"
+
+// Per-probe soil readings, one array per field so a scan writes and the
+// JSON frame reads contiguous memory
+struct ProbeReadings {
+    uint16_t raw[SOIL_PROBE_COUNT];       // averaged ADC counts
+    int16_t moisture[SOIL_PROBE_COUNT];   // 0.1 %
+};
+
+#define CAL_POINTS_MAX 6  // Calibration points per probe
+
+// Per-probe calibration curves, points sorted by ADC counts. A probe with
+// fewer than 2 points uses the compile-time SOIL_CAL_POINTS table.
+struct ProbeCalibration {
+    uint8_t count[SOIL_PROBE_COUNT];
+    CalPoint points[SOIL_PROBE_COUNT][CAL_POINTS_MAX];
+};
 
 struct SystemState {
-    float soilMoisture;
+    float soilMoisture;            // mean of the probes
+    ProbeReadings probes;
     float temperature;
     float humidity;
     bool pumpActive;
+    int8_t activeZone;             // zone being watered, -1 when the pump is off
     bool autoMode;
     unsigned long lastWatering;
     unsigned long lastMeasurement;
+    unsigned long measurementInterval;  // current adaptive sampling interval (ms)
     
     // Safety monitoring
     uint8_t pumpCyclesThisHour;
@@ -18,10 +39,12 @@ struct SystemState {
     bool sensorError;
     uint8_t sensorErrorCount;
     unsigned long pumpStartTime;
-    unsigned long lastPumpCycle;
+    unsigned long lastPumpCycle;   // millis() when the pump last stopped (cooldown reference)
     bool systemReady;
 };
 
+// Shared pump limits (PlantController::config) and, per irrigation zone,
+// thresholds and run length (PlantController::zones)
 struct SystemConfig {
     bool autoMode;
     int moistureThresholdLow;
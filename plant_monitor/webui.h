@@ -1,299 +1,169 @@
+// Generated by tools/webui_gen.py from web/index.html - do not edit
 #ifndef WEBUI_H
 #define WEBUI_H
 
-const char INDEX_HTML[] PROGMEM = R"rawliteral(
-<!DOCTYPE html>
-<html lang="en">
-<head>
-    <meta charset="UTF-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1.0, maximum-scale=1.0, user-scalable=no">
-    <title>Plant Guardian Pro</title>
-    <style>
-        * {
-            margin: 0;
-            padding: 0;
-            box-sizing: border-box;
-            font-family: system-ui, -apple-system, sans-serif;
-            -webkit-tap-highlight-color: transparent;
-        }
-        :root {
-            --primary: #4CAF50;
-            --danger: #f44336;
-            --warning: #ff9800;
-            --bg: #f5f5f5;
-            --card: #fff;
-        }
-        body {
-            background: var(--bg);
-            padding: 1rem;
-            line-height: 1.5;
-        }
-        .header {
-            background: var(--primary);
-            color: white;
-            padding: 1.5rem;
-            border-radius: 1rem;
-            margin-bottom: 1rem;
-            text-align: center;
-        }
-        .status {
-            display: inline-flex;
-            align-items: center;
-            gap: 0.5rem;
-            background: rgba(255,255,255,0.2);
-            padding: 0.5rem 1rem;
-            border-radius: 2rem;
-            margin-top: 0.5rem;
-            font-size: 0.9rem;
-        }
-        .grid {
-            display: grid;
-            grid-template-columns: repeat(auto-fit, minmax(140px, 1fr));
-            gap: 1rem;
-            margin-bottom: 1rem;
-        }
-        .card {
-            background: var(--card);
-            padding: 1rem;
-            border-radius: 1rem;
-            box-shadow: 0 2px 4px rgba(0,0,0,0.1);
-            text-align: center;
-        }
-        .card.error {
-            border: 2px solid var(--danger);
-        }
-        .value {
-            font-size: 2rem;
-            font-weight: bold;
-            margin: 0.5rem 0;
-        }
-        .label {
-            font-size: 0.9rem;
-            color: #666;
-        }
-        .controls {
-            background: var(--card);
-            padding: 1rem;
-            border-radius: 1rem;
-            box-shadow: 0 2px 4px rgba(0,0,0,0.1);
-        }
-        .switch-row {
-            display: flex;
-            justify-content: space-between;
-            align-items: center;
-            margin-bottom: 1rem;
-            padding-bottom: 1rem;
-            border-bottom: 1px solid #eee;
-        }
-        .switch {
-            position: relative;
-            width: 60px;
-            height: 34px;
-        }
-        .switch input {
-            opacity: 0;
-            width: 0;
-            height: 0;
-        }
-        .slider {
-            position: absolute;
-            cursor: pointer;
-            top: 0;
-            left: 0;
-            right: 0;
-            bottom: 0;
-            background-color: #ccc;
-            transition: .4s;
-            border-radius: 34px;
-        }
-        .slider:before {
-            position: absolute;
-            content: "";
-            height: 26px;
-            width: 26px;
-            left: 4px;
-            bottom: 4px;
-            background-color: white;
-            transition: .4s;
-            border-radius: 50%;
-        }
-        input:checked + .slider {
-            background-color: var(--primary);
-        }
-        input:checked + .slider:before {
-            transform: translateX(26px);
-        }
-        .button {
-            width: 100%;
-            padding: 1rem;
-            border: none;
-            border-radius: 0.5rem;
-            background: var(--primary);
-            color: white;
-            font-size: 1rem;
-            font-weight: bold;
-            cursor: pointer;
-        }
-        .button:disabled {
-            opacity: 0.5;
-            cursor: not-allowed;
-        }
-        .toast {
-            position: fixed;
-            bottom: 1rem;
-            left: 50%;
-            transform: translateX(-50%);
-            background: rgba(0,0,0,0.8);
-            color: white;
-            padding: 0.75rem 1.5rem;
-            border-radius: 2rem;
-            font-size: 0.9rem;
-            opacity: 0;
-            transition: 0.3s;
-        }
-        .toast.show {
-            opacity: 1;
-        }
-    </style>
-</head>
-<body>
-    <div class="header">
-        <h1>Plant Guardian Pro</h1>
-        <p>Smart Plant Monitor</p>
-        <div class="status" id="wifi-status">
-            <span>●</span>
-            <span id="status-text">Connected</span>
-        </div>
-    </div>
+#define INDEX_HTML_GZ_LEN 2527
+#define INDEX_HTML_ETAG "\"857a4c683144e85d\""
 
-    <div class="grid">
-        <div class="card" id="moisture-card">
-            <div class="value" id="moisture-value">---%</div>
-            <div class="label">Soil Moisture</div>
-        </div>
-        <div class="card" id="temp-card">
-            <div class="value" id="temp-value">---°C</div>
-            <div class="label">Temperature</div>
-        </div>
-        <div class="card" id="humidity-card">
-            <div class="value" id="humidity-value">---%</div>
-            <div class="label">Humidity</div>
-        </div>
-    </div>
+const uint8_t INDEX_HTML_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xcd, 0x5a, 0xef, 0x72, 0xdb, 0xb8,
+    0x11, 0xff, 0x9e, 0xa7, 0x40, 0xe4, 0x64, 0x48, 0xb5, 0x22, 0x25, 0xdb, 0x92, 0x2f, 0xa7, 0x48,
+    0xba, 0x49, 0x9d, 0xa4, 0x77, 0x9d, 0xa4, 0xc9, 0x8c, 0xdd, 0x69, 0xfb, 0x29, 0x81, 0x48, 0x48,
+    0x42, 0x42, 0x12, 0x1c, 0x00, 0xb4, 0xec, 0xe6, 0xfc, 0x0c, 0xfd, 0xd8, 0xd7, 0xe8, 0x33, 0xf4,
+    0x51, 0xfa, 0x24, 0x5d, 0x00, 0xa4, 0x44, 0x81, 0xa0, 0x64, 0x39, 0xed, 0x4c, 0xe5, 0xf1, 0x98,
+    0x04, 0xb0, 0x8b, 0xfd, 0x87, 0xfd, 0xed, 0xc2, 0x9a, 0x3c, 0x7d, 0xfd, 0xe1, 0xf2, 0xfa, 0xaf,
+    0x1f, 0xdf, 0xa0, 0x95, 0x4c, 0x93, 0xd9, 0x93, 0x89, 0xfa, 0x83, 0x12, 0x9c, 0x2d, 0xa7, 0x1d,
+    0x92, 0x75, 0xd4, 0x00, 0xc1, 0xf1, 0xec, 0x09, 0x82, 0xcf, 0x24, 0x25, 0x12, 0xa3, 0x68, 0x85,
+    0xb9, 0x20, 0x72, 0xda, 0xf9, 0xd3, 0xf5, 0xdb, 0xe0, 0x45, 0xa7, 0x3e, 0x95, 0xe1, 0x94, 0x4c,
+    0x3b, 0x37, 0x94, 0xac, 0x73, 0xc6, 0x65, 0x07, 0x45, 0x2c, 0x93, 0x24, 0x83, 0xa5, 0x6b, 0x1a,
+    0xcb, 0xd5, 0x34, 0x26, 0x37, 0x34, 0x22, 0x81, 0x7e, 0xe9, 0x21, 0x9a, 0x51, 0x49, 0x71, 0x12,
+    0x88, 0x08, 0x27, 0x64, 0x7a, 0x1a, 0x0e, 0x7a, 0x28, 0xc5, 0xb7, 0x34, 0x2d, 0xd2, 0xfa, 0x50,
+    0x21, 0x08, 0xd7, 0xef, 0x78, 0x0e, 0x43, 0x19, 0xab, 0xf6, 0x93, 0x54, 0x26, 0x64, 0xf6, 0x11,
+    0x04, 0x95, 0xe8, 0xf7, 0x05, 0xe6, 0x31, 0xc5, 0x19, 0xfa, 0xc8, 0xd9, 0xa4, 0x6f, 0x66, 0xcc,
+    0x2a, 0x21, 0xef, 0xaa, 0x67, 0xf5, 0xf9, 0x0d, 0xfa, 0xb6, 0x79, 0x56, 0x9f, 0x14, 0xf3, 0x25,
+    0xcd, 0xc6, 0x68, 0xf0, 0x72, 0x67, 0x38, 0xc7, 0x71, 0x4c, 0xb3, 0x65, 0x63, 0x7c, 0xce, 0x6e,
+    0x03, 0x41, 0xff, 0xa6, 0xa7, 0xe6, 0x8c, 0xc7, 0x20, 0x19, 0x0c, 0xed, 0xae, 0x59, 0x80, 0xca,
+    0xc1, 0x02, 0xa7, 0x34, 0xb9, 0x1b, 0x23, 0x71, 0x27, 0x24, 0x49, 0x83, 0x82, 0xf6, 0x50, 0x80,
+    0xf3, 0x3c, 0x21, 0x81, 0x19, 0xe9, 0x21, 0x81, 0x33, 0x11, 0x80, 0x6a, 0x74, 0xb1, 0x4b, 0x1e,
+    0xac, 0xc9, 0xfc, 0x2b, 0x95, 0x81, 0xc4, 0x79, 0xb0, 0xa2, 0xcb, 0x55, 0x02, 0xbf, 0x32, 0x88,
+    0x58, 0xc2, 0xf8, 0x18, 0x49, 0x0e, 0x54, 0x39, 0xe6, 0x60, 0xd2, 0x2d, 0xd5, 0xfd, 0xe6, 0x69,
+    0xcc, 0x19, 0x93, 0x96, 0x86, 0x41, 0x90, 0x73, 0x0a, 0x6a, 0x82, 0x30, 0x27, 0xc3, 0xcb, 0x57,
+    0x6f, 0x47, 0x96, 0x4a, 0x41, 0x10, 0x83, 0xab, 0x09, 0x30, 0x3f, 0x59, 0x0c, 0x87, 0xe7, 0xe7,
+    0x17, 0xf6, 0xf4, 0x1a, 0xf3, 0x4c, 0x2b, 0x7c, 0xb2, 0x58, 0xfc, 0xf8, 0x62, 0xd0, 0x20, 0x9f,
+    0xeb, 0xa9, 0x91, 0xfa, 0xb1, 0xa7, 0x22, 0xf0, 0x8a, 0xa6, 0x5b, 0xb8, 0xa4, 0x9d, 0xb3, 0xf8,
+    0xce, 0x12, 0x76, 0x8e, 0xa3, 0xaf, 0x4b, 0xce, 0x8a, 0x0c, 0xc8, 0x6e, 0x30, 0xf7, 0x15, 0xf7,
+    0x6e, 0x8b, 0x6b, 0x4e, 0x39, 0x49, 0x77, 0xa7, 0x12, 0x9a, 0x91, 0x60, 0x45, 0x94, 0xc1, 0x60,
+    0x3a, 0x1c, 0xb9, 0x36, 0x0d, 0x55, 0x30, 0x13, 0x7e, 0x70, 0xdf, 0xd2, 0x68, 0xd6, 0xe6, 0xa5,
+    0x1b, 0xd6, 0x2b, 0x2a, 0x49, 0x9b, 0x58, 0xe1, 0xa8, 0x21, 0x58, 0x19, 0x2a, 0x1c, 0xc7, 0xb4,
+    0x10, 0x2e, 0xc9, 0x4d, 0x18, 0x42, 0x2c, 0x49, 0xc9, 0x52, 0xd7, 0x02, 0x49, 0x6e, 0x65, 0x80,
+    0x21, 0x16, 0x20, 0x56, 0x23, 0xf0, 0x3e, 0xe1, 0x4e, 0xe5, 0x84, 0xc4, 0xb2, 0x10, 0x96, 0x72,
+    0x31, 0x15, 0x79, 0x82, 0xc1, 0xff, 0x34, 0xd3, 0x16, 0x5a, 0x24, 0xc4, 0x0a, 0x59, 0xcd, 0x38,
+    0x00, 0x9d, 0x52, 0xd1, 0x64, 0xaf, 0x3e, 0x4b, 0x9c, 0xc3, 0x59, 0x70, 0x69, 0x56, 0x33, 0x1c,
+    0x5f, 0xce, 0xb1, 0x7f, 0x36, 0x1a, 0xf5, 0xaa, 0xdf, 0x41, 0x78, 0xd6, 0xe6, 0x3c, 0xc3, 0xcb,
+    0xa1, 0xa8, 0x65, 0xaa, 0xb3, 0x36, 0x53, 0x49, 0xd6, 0x22, 0x91, 0x3e, 0x7e, 0x70, 0x46, 0x89,
+    0x9a, 0xfe, 0x71, 0x67, 0xba, 0x66, 0xa8, 0x25, 0xa7, 0x71, 0x9b, 0x99, 0xd4, 0x9c, 0xa5, 0x3e,
+    0x8c, 0x04, 0x60, 0x1d, 0x98, 0x97, 0x44, 0x9d, 0xc5, 0x22, 0xcd, 0x40, 0x38, 0x4e, 0x72, 0x82,
+    0xa5, 0x8f, 0x0b, 0xc9, 0x82, 0x05, 0x95, 0x90, 0xbd, 0x68, 0x06, 0x09, 0xcc, 0x3f, 0x1d, 0x0e,
+    0xf2, 0xdb, 0x1e, 0x3a, 0x5d, 0xf0, 0x6e, 0xd7, 0x61, 0xc7, 0x23, 0xdd, 0x5f, 0x93, 0x5a, 0x9d,
+    0xa7, 0x83, 0x91, 0xab, 0x16, 0x3d, 0xfc, 0xcc, 0x1c, 0x0c, 0x4d, 0x9d, 0xf2, 0x56, 0x38, 0x66,
+    0x6b, 0x30, 0x28, 0x3a, 0xcb, 0x6f, 0xd1, 0x10, 0x7e, 0xb5, 0xaf, 0x07, 0x3d, 0xfd, 0x13, 0x9e,
+    0x76, 0x1f, 0x15, 0xac, 0x4a, 0xd0, 0x90, 0x70, 0xce, 0x1a, 0xa7, 0x51, 0xcb, 0x34, 0xd6, 0x9b,
+    0x09, 0x96, 0x80, 0xa7, 0x8c, 0x66, 0x26, 0x51, 0x75, 0x9d, 0xcc, 0x6e, 0x70, 0x52, 0x10, 0x8b,
+    0x4f, 0x2d, 0x14, 0xce, 0xdc, 0x71, 0xb2, 0x2e, 0x93, 0xc5, 0x9c, 0x25, 0xf1, 0x4b, 0x37, 0x30,
+    0x98, 0x40, 0x1d, 0x38, 0x37, 0x05, 0x48, 0x22, 0x49, 0xfb, 0xa6, 0x76, 0xfc, 0xd5, 0x32, 0xc8,
+    0xc9, 0xc5, 0xc5, 0x85, 0xdb, 0x28, 0x40, 0xce, 0x59, 0x22, 0xfe, 0xcf, 0xdd, 0x5c, 0xcf, 0x39,
+    0x6b, 0x2a, 0xa3, 0x55, 0xc0, 0xd9, 0xba, 0xed, 0x40, 0x35, 0x13, 0xce, 0x97, 0x42, 0x48, 0xba,
+    0xb8, 0x0b, 0xca, 0xf2, 0x00, 0x70, 0x32, 0xc7, 0x50, 0x17, 0xcc, 0x89, 0x5c, 0x13, 0x92, 0x1d,
+    0x99, 0x9c, 0x0e, 0x26, 0xcf, 0xd2, 0x2e, 0x7b, 0x56, 0x6c, 0xb0, 0xbc, 0x5c, 0xb0, 0x09, 0xbc,
+    0x13, 0x42, 0xc8, 0x1e, 0xad, 0x2d, 0x8d, 0x73, 0x26, 0xa0, 0xa2, 0x61, 0x99, 0x4a, 0x0d, 0x90,
+    0x2a, 0xe8, 0x8d, 0x05, 0x12, 0xba, 0xee, 0x19, 0xa3, 0x0b, 0x48, 0x0f, 0xbb, 0x13, 0x15, 0x68,
+    0x9d, 0x0f, 0xeb, 0x33, 0xcd, 0xed, 0x68, 0x96, 0x17, 0x36, 0xc0, 0x33, 0x30, 0x1d, 0x95, 0x77,
+    0x8d, 0x5a, 0xa5, 0xdc, 0x6c, 0xe0, 0xde, 0xc9, 0x1d, 0xd0, 0x02, 0x74, 0x6e, 0x80, 0xe3, 0x56,
+    0x2b, 0x3c, 0x07, 0xab, 0x14, 0x36, 0xf4, 0x45, 0x05, 0x17, 0x2a, 0xa6, 0x73, 0x46, 0x9b, 0xce,
+    0x31, 0x79, 0xda, 0xc2, 0x69, 0xb2, 0x90, 0x8d, 0x41, 0xde, 0x90, 0xcb, 0x38, 0xc6, 0x78, 0x64,
+    0xd0, 0x06, 0x3b, 0x55, 0x65, 0x74, 0x12, 0x45, 0x91, 0xb5, 0xb3, 0xaa, 0x95, 0x4a, 0xc1, 0xc3,
+    0xa1, 0xd8, 0x7b, 0x1e, 0xda, 0xed, 0xae, 0x0d, 0x32, 0x9e, 0x93, 0x05, 0xe3, 0xe4, 0x58, 0xbb,
+    0x54, 0xc1, 0xdd, 0xe9, 0xb8, 0x7d, 0x70, 0x76, 0x61, 0xc7, 0x41, 0xe9, 0xb3, 0xe6, 0x84, 0x31,
+    0xd9, 0xd0, 0x1e, 0xae, 0xcc, 0xd3, 0x9c, 0x68, 0x18, 0xc8, 0x51, 0xb3, 0x1c, 0x63, 0xa1, 0xd1,
+    0xe0, 0xb9, 0xcb, 0x40, 0x3a, 0x20, 0xc7, 0xd1, 0x8a, 0x44, 0x5f, 0x49, 0x8c, 0x7e, 0xdb, 0x12,
+    0x41, 0x4d, 0x69, 0xda, 0x8a, 0xac, 0x83, 0x9c, 0xdd, 0xae, 0xd0, 0x9a, 0xc0, 0x78, 0x5a, 0x96,
+    0xc8, 0x0a, 0xa7, 0xff, 0xe2, 0x2b, 0x33, 0xba, 0x73, 0xd6, 0xbc, 0x00, 0xbb, 0x65, 0x16, 0x93,
+    0xd2, 0xf8, 0xa7, 0x83, 0xba, 0xaa, 0x0f, 0xca, 0xab, 0x63, 0x94, 0xb1, 0x8c, 0xec, 0xb5, 0xdf,
+    0xa1, 0xe2, 0xe9, 0x71, 0x55, 0x67, 0x0d, 0x6c, 0x4e, 0x8f, 0x45, 0xb8, 0xd6, 0x63, 0xdb, 0xb0,
+    0xd3, 0x18, 0x32, 0xb9, 0x6a, 0xbe, 0xe2, 0xd6, 0xcc, 0x13, 0x8e, 0xdc, 0xbc, 0x33, 0xa6, 0x0a,
+    0x81, 0x84, 0xad, 0x49, 0xec, 0xe4, 0x9f, 0x73, 0x36, 0x27, 0xe2, 0xbf, 0x5c, 0x88, 0x25, 0xc9,
+    0xa6, 0x12, 0x1b, 0x72, 0xd5, 0x6a, 0xb5, 0x15, 0x62, 0x2e, 0x9f, 0x3c, 0xb4, 0x14, 0x33, 0x92,
+    0x8f, 0x41, 0x14, 0x79, 0xd7, 0x26, 0xff, 0x6e, 0x50, 0xd8, 0xc4, 0x7b, 0x10, 0xde, 0xe1, 0xe9,
+    0x07, 0x84, 0x93, 0x55, 0x5c, 0x3f, 0xbc, 0x26, 0x6b, 0x94, 0x2d, 0x2f, 0x46, 0x6d, 0x6a, 0x4b,
+    0x86, 0x85, 0x6c, 0xcd, 0x83, 0x0b, 0x7a, 0x4b, 0x62, 0x77, 0x86, 0x72, 0x74, 0x6b, 0x3a, 0xa5,
+    0x8d, 0xec, 0xc3, 0xe6, 0x3e, 0xca, 0x01, 0xac, 0xeb, 0x1e, 0x68, 0x3d, 0xaa, 0x3a, 0xe5, 0xc5,
+    0xf1, 0x4d, 0xdb, 0x20, 0xfc, 0xc1, 0xf4, 0x23, 0x87, 0x9b, 0xb7, 0xb3, 0x63, 0x3a, 0x8e, 0x7d,
+    0xf8, 0x5c, 0xcf, 0xbe, 0x83, 0xf0, 0x5c, 0xb4, 0xdb, 0x3b, 0x14, 0xab, 0x46, 0x71, 0xb5, 0xe1,
+    0x7a, 0x6a, 0xd3, 0x4d, 0xfa, 0xe5, 0x9d, 0xc7, 0xa4, 0x6f, 0x2e, 0x6e, 0x26, 0xaa, 0xd1, 0x2e,
+    0xaf, 0x43, 0x62, 0x7a, 0x83, 0xa2, 0x04, 0x0b, 0x31, 0xed, 0x98, 0x46, 0xb8, 0xb3, 0xbd, 0x1b,
+    0x99, 0xac, 0x4e, 0x9d, 0xd7, 0x29, 0x30, 0xbc, 0x5d, 0x93, 0xcf, 0xae, 0xe0, 0x88, 0x48, 0x64,
+    0x16, 0xbe, 0x67, 0x19, 0x95, 0x8c, 0x4f, 0xfa, 0x79, 0x6d, 0x49, 0x6d, 0x0f, 0xd3, 0x8f, 0x76,
+    0x10, 0x8d, 0xd5, 0x0d, 0xd0, 0x82, 0x06, 0xe5, 0xc0, 0x6c, 0x47, 0x97, 0x09, 0x54, 0x7f, 0xd9,
+    0xec, 0xdf, 0xff, 0xf8, 0x3b, 0x88, 0xae, 0x9e, 0x9a, 0x93, 0x9a, 0x81, 0xa1, 0x0d, 0x54, 0x24,
+    0x77, 0x66, 0x97, 0x2c, 0xcb, 0x48, 0x24, 0x49, 0x6c, 0xd3, 0x4c, 0xfa, 0xb0, 0x7f, 0xa9, 0xad,
+    0x79, 0x6c, 0x68, 0xae, 0xb2, 0x48, 0xc7, 0x2d, 0xb0, 0xaa, 0xaa, 0x8d, 0xb8, 0x29, 0xa3, 0x42,
+    0x16, 0x9c, 0xe8, 0x42, 0xdb, 0x16, 0xb8, 0x46, 0xa1, 0x1b, 0x0f, 0x8b, 0xc4, 0x8c, 0xcd, 0x82,
+    0x20, 0x78, 0x5e, 0x13, 0xc7, 0x45, 0xad, 0x3b, 0x88, 0xce, 0xec, 0x8a, 0xd1, 0x04, 0x8c, 0x69,
+    0xc8, 0x2d, 0x12, 0xfb, 0xd5, 0x29, 0xad, 0xca, 0x89, 0x47, 0x48, 0xaa, 0x97, 0x6f, 0xa5, 0xfc,
+    0xd7, 0x3f, 0x2f, 0x1f, 0x26, 0xe7, 0x35, 0xd0, 0x11, 0x8e, 0x1f, 0x2b, 0xe5, 0xaa, 0x48, 0x69,
+    0x0c, 0x51, 0x7b, 0x84, 0xa4, 0x1b, 0x92, 0xa3, 0x6d, 0xfa, 0x73, 0x49, 0xd9, 0x2e, 0x68, 0x5b,
+    0x7c, 0x98, 0xdc, 0x6e, 0xf6, 0x2f, 0x9f, 0x67, 0x6d, 0x6b, 0xab, 0x7e, 0xad, 0x25, 0x9e, 0xb6,
+    0xcd, 0x91, 0x33, 0xe6, 0x5f, 0x01, 0x62, 0x81, 0xdf, 0x63, 0xe2, 0x8c, 0x7c, 0xd3, 0x5e, 0xee,
+    0x70, 0xb2, 0xb8, 0xe8, 0x65, 0xa6, 0x29, 0x90, 0x77, 0x39, 0x01, 0x71, 0x54, 0xbd, 0x04, 0xbd,
+    0x9c, 0x11, 0x5e, 0x03, 0x62, 0x0a, 0xec, 0x3b, 0xa8, 0x2a, 0xa4, 0x58, 0x16, 0xad, 0x54, 0x1b,
+    0x0d, 0x31, 0xc0, 0x96, 0xcb, 0x84, 0x28, 0x09, 0xfc, 0xae, 0x8b, 0xad, 0x3e, 0x77, 0xd5, 0xe6,
+    0xba, 0xf6, 0x52, 0x56, 0x70, 0x88, 0xd9, 0xd7, 0x72, 0xb6, 0x87, 0x42, 0x59, 0x6c, 0x95, 0xac,
+    0xcc, 0x5b, 0x69, 0xdc, 0x02, 0xc2, 0xb0, 0x1a, 0x00, 0xc9, 0x12, 0x1a, 0x7d, 0xad, 0x04, 0xfb,
+    0x08, 0x73, 0x0d, 0xc1, 0xae, 0xa4, 0xca, 0x3d, 0x7f, 0x06, 0x48, 0xe0, 0x90, 0xb7, 0x6b, 0x3b,
+    0x1a, 0x26, 0xfb, 0xdd, 0xaa, 0x73, 0x69, 0x19, 0xff, 0xfa, 0x71, 0xd7, 0xa9, 0x22, 0xe2, 0x34,
+    0x97, 0xdb, 0xfd, 0x12, 0x22, 0x91, 0x12, 0xf0, 0x55, 0xa4, 0x1a, 0x39, 0x34, 0x45, 0x0b, 0x9c,
+    0x88, 0x1a, 0x80, 0xa8, 0x79, 0x72, 0x03, 0x50, 0x7a, 0xc5, 0x0a, 0x1e, 0xc1, 0xc4, 0x66, 0x66,
+    0x51, 0x64, 0x91, 0xca, 0xeb, 0x48, 0xe5, 0xed, 0x6b, 0xb5, 0x95, 0x9f, 0x12, 0x21, 0xf0, 0x92,
+    0x74, 0xad, 0x2c, 0x0e, 0xd1, 0x03, 0x70, 0x6a, 0x40, 0x75, 0x8a, 0x62, 0x16, 0x15, 0x29, 0x30,
+    0x0c, 0x97, 0x44, 0xbe, 0x49, 0x88, 0x7a, 0xfc, 0xdd, 0xdd, 0x2f, 0xb1, 0xef, 0xe9, 0x05, 0x9e,
+    0x7d, 0xcb, 0xa2, 0xa1, 0x41, 0x65, 0xc3, 0x4b, 0xd3, 0x68, 0x00, 0x87, 0x72, 0x1b, 0xd7, 0x42,
+    0x6d, 0x84, 0x77, 0x90, 0x61, 0x42, 0x00, 0x3d, 0xdf, 0x53, 0xa2, 0xd9, 0x1c, 0x05, 0x91, 0xd7,
+    0x34, 0x25, 0xac, 0x90, 0xbe, 0xdf, 0x45, 0xd3, 0x59, 0x83, 0x12, 0xb0, 0x8d, 0xdd, 0x90, 0x8a,
+    0xb8, 0x87, 0xce, 0x07, 0x83, 0xc1, 0x4e, 0x81, 0xdd, 0x34, 0x41, 0x91, 0xc7, 0xe0, 0xad, 0x4b,
+    0x38, 0xef, 0x3e, 0x8d, 0x7b, 0x48, 0x9f, 0xe2, 0x1e, 0x2a, 0x00, 0x36, 0xdc, 0xb6, 0xd0, 0x57,
+    0x5c, 0xed, 0xa6, 0xa0, 0xaa, 0x15, 0xf0, 0x74, 0xfe, 0xf0, 0x1a, 0x30, 0xaf, 0xe8, 0xf5, 0x06,
+    0x8a, 0xe2, 0x30, 0x13, 0xbd, 0xd4, 0xe6, 0xb2, 0xf3, 0x42, 0x17, 0xc8, 0x37, 0x17, 0x4b, 0xd3,
+    0xe9, 0x14, 0x65, 0x45, 0x92, 0xd8, 0x42, 0xeb, 0x8d, 0xd5, 0x3d, 0x96, 0x65, 0x5e, 0x7d, 0xad,
+    0x65, 0xf3, 0x56, 0x9f, 0x8d, 0x7c, 0x96, 0xe7, 0xbc, 0x37, 0x9a, 0xa2, 0x49, 0xc0, 0x09, 0x64,
+    0x5b, 0xeb, 0x4a, 0xe4, 0xbe, 0x5d, 0x64, 0x4b, 0x98, 0xca, 0x63, 0x4e, 0x79, 0xda, 0x64, 0xf9,
+    0xfc, 0xec, 0x9b, 0x9e, 0xba, 0x7f, 0xf6, 0x4d, 0x39, 0xea, 0xfe, 0xb3, 0xd3, 0xc5, 0xfd, 0x3e,
+    0xfa, 0x90, 0x11, 0x24, 0x69, 0x42, 0x10, 0x80, 0x02, 0x32, 0x45, 0xed, 0x7a, 0x45, 0x32, 0x84,
+    0x51, 0x5a, 0xdc, 0x22, 0x2a, 0xa0, 0x20, 0x94, 0x00, 0xd1, 0x2f, 0x61, 0x40, 0xc0, 0x79, 0x55,
+    0x0b, 0xf5, 0x22, 0x98, 0x91, 0x2b, 0x62, 0x7c, 0x8d, 0xe7, 0x20, 0x60, 0x5b, 0xdc, 0x7c, 0xd4,
+    0xd9, 0xd7, 0x37, 0x49, 0xb8, 0x25, 0x60, 0x40, 0x6c, 0x4c, 0x33, 0x10, 0x60, 0xcf, 0x01, 0x32,
+    0x0c, 0x6c, 0xfd, 0x95, 0x7b, 0x9f, 0x96, 0x2d, 0xc8, 0xaf, 0xbf, 0x1a, 0xd9, 0x44, 0x98, 0x90,
+    0x6c, 0x29, 0x57, 0x68, 0x82, 0xce, 0xba, 0x4e, 0xe3, 0x6f, 0x36, 0x0c, 0x29, 0x94, 0x20, 0xfc,
+    0xe7, 0xeb, 0xf7, 0xef, 0x60, 0x6b, 0x43, 0xdc, 0xf0, 0x5e, 0x98, 0xe2, 0xdc, 0xf7, 0xcb, 0xa8,
+    0xa7, 0xfa, 0x50, 0x7d, 0x6e, 0x40, 0x4d, 0x67, 0xf6, 0xec, 0x1b, 0x85, 0x90, 0x3c, 0xbd, 0x1f,
+    0xa3, 0xca, 0xf4, 0x25, 0xc8, 0x7d, 0xee, 0x36, 0x59, 0x7e, 0x81, 0x86, 0xcd, 0xf7, 0xbc, 0x03,
+    0x07, 0xaf, 0x9e, 0xde, 0x9d, 0x86, 0xa3, 0x42, 0xa3, 0xcf, 0x1e, 0xab, 0x6d, 0xe0, 0xc3, 0xeb,
+    0x86, 0x25, 0x7e, 0x58, 0x95, 0x2f, 0x01, 0x48, 0xf2, 0xbd, 0x3e, 0xce, 0x69, 0xbf, 0x04, 0xc2,
+    0x9f, 0x14, 0xd1, 0xd4, 0x03, 0x6d, 0x0c, 0x7f, 0x87, 0xfc, 0x11, 0x56, 0x54, 0x26, 0xc3, 0x6c,
+    0x33, 0xa4, 0xf7, 0x16, 0x53, 0xd5, 0x62, 0x82, 0x48, 0x06, 0xa1, 0x90, 0xd9, 0xf9, 0x41, 0x6a,
+    0x1a, 0xb0, 0xb0, 0xfb, 0x92, 0x7a, 0xf2, 0x7e, 0xba, 0x7d, 0x73, 0xa5, 0x8d, 0xb9, 0xcc, 0xf6,
+    0xc6, 0xcf, 0x16, 0xa8, 0xec, 0x20, 0x02, 0x4a, 0xeb, 0xf8, 0xd4, 0xf6, 0xfd, 0x09, 0x79, 0x57,
+    0x92, 0xe5, 0x1b, 0xc4, 0xf2, 0xd0, 0x58, 0x8d, 0xd4, 0x41, 0xcc, 0xdb, 0x93, 0x7f, 0x5c, 0xf6,
+    0x55, 0xdc, 0xb5, 0x7d, 0xb7, 0xdb, 0x1c, 0xb0, 0x71, 0x33, 0x63, 0x3d, 0xdc, 0x3a, 0xff, 0x23,
+    0x2d, 0x37, 0x88, 0xe3, 0x74, 0xbf, 0xd1, 0x54, 0xef, 0xe0, 0x4a, 0xa1, 0xf7, 0x07, 0x42, 0x42,
+    0xfd, 0x5b, 0xf9, 0xcd, 0x16, 0x98, 0x1b, 0x71, 0xa1, 0x8e, 0x7d, 0x0d, 0xb8, 0xbb, 0x75, 0x14,
+    0x87, 0xd4, 0xc9, 0x04, 0x90, 0xec, 0x71, 0x4a, 0x6d, 0x35, 0x98, 0x21, 0x23, 0x6b, 0x54, 0xdf,
+    0xcc, 0xeb, 0xeb, 0x79, 0xe1, 0x3d, 0x90, 0x85, 0x82, 0x0b, 0x4d, 0xaf, 0xd2, 0x35, 0x81, 0x7c,
+    0x02, 0xe8, 0x4a, 0x32, 0xc1, 0xb8, 0xf0, 0x7a, 0x88, 0xb8, 0xdd, 0x67, 0x42, 0x16, 0xf2, 0x23,
+    0x06, 0x01, 0xfe, 0x70, 0xf5, 0xe1, 0x8f, 0x61, 0xae, 0xfe, 0x21, 0xef, 0x93, 0x50, 0x8d, 0x39,
+    0x2c, 0x56, 0x03, 0x61, 0xaf, 0x6a, 0x52, 0x80, 0xbd, 0x5a, 0x1d, 0x0a, 0x68, 0x3d, 0x3e, 0x55,
+    0x83, 0x3d, 0xe4, 0x3d, 0xf7, 0x0e, 0x30, 0x50, 0xbd, 0x43, 0x45, 0x2c, 0xb7, 0xfd, 0x00, 0x90,
+    0x42, 0x1b, 0x71, 0x88, 0xb8, 0x2a, 0xe7, 0x2b, 0x06, 0xd5, 0xfb, 0xfe, 0x8d, 0x4b, 0x18, 0xd0,
+    0x14, 0x25, 0x16, 0x34, 0x97, 0x36, 0x06, 0x1e, 0x76, 0x9a, 0xc3, 0xcd, 0xe5, 0xd6, 0xb4, 0x34,
+    0x88, 0x36, 0xff, 0x27, 0x8d, 0x98, 0x16, 0xec, 0x76, 0x6b, 0x45, 0xde, 0x61, 0x3f, 0xea, 0xf8,
+    0x6d, 0x75, 0xe2, 0xce, 0xf9, 0x33, 0x9e, 0xd3, 0x55, 0x86, 0x26, 0xfb, 0x04, 0x92, 0xbd, 0x7c,
+    0xac, 0x42, 0xbb, 0xe7, 0xf4, 0xd0, 0xe1, 0x7f, 0xdc, 0xe1, 0xdd, 0x1e, 0xdc, 0x5d, 0x56, 0x15,
+    0x09, 0x12, 0x8a, 0x03, 0x89, 0x35, 0xb7, 0xda, 0x20, 0xcb, 0x73, 0xd2, 0xa8, 0xdc, 0x8e, 0xb4,
+    0xab, 0x42, 0x98, 0x43, 0x87, 0x63, 0x03, 0x6e, 0x75, 0xcb, 0x2a, 0xc2, 0x23, 0x2d, 0xeb, 0x80,
+    0x40, 0x60, 0x6a, 0xb8, 0xef, 0xb3, 0x4a, 0xb9, 0x3f, 0x58, 0x44, 0xff, 0x55, 0x1c, 0x10, 0xc9,
+    0x74, 0x9c, 0x69, 0x93, 0x6c, 0x47, 0xab, 0xf0, 0x3b, 0xca, 0x28, 0x2c, 0x33, 0xff, 0x37, 0x9d,
+    0xa2, 0xb6, 0x14, 0xdf, 0xaa, 0x51, 0xed, 0x16, 0xa5, 0x11, 0x2b, 0xde, 0x6b, 0x2a, 0xa2, 0xea,
+    0x62, 0xe5, 0x18, 0x33, 0xd5, 0xee, 0x76, 0x80, 0xa9, 0xbe, 0x7f, 0x0a, 0xb7, 0xf7, 0x73, 0x8a,
+    0xb3, 0xf9, 0x72, 0xc0, 0x70, 0xd8, 0xbb, 0xf8, 0xa1, 0x37, 0x1a, 0xea, 0xaf, 0x06, 0xb8, 0xc2,
+    0x6a, 0xdb, 0x81, 0x58, 0x59, 0xbc, 0x87, 0x46, 0xbb, 0xcd, 0x86, 0xb6, 0x51, 0x5b, 0x61, 0x6a,
+    0xe2, 0x57, 0xd5, 0x98, 0x38, 0xcf, 0x9f, 0x34, 0xc4, 0x6f, 0xc6, 0xd4, 0xeb, 0x0f, 0xef, 0x4b,
+    0x33, 0xbc, 0x63, 0x38, 0x06, 0xe5, 0x7b, 0x4e, 0xcb, 0x36, 0xa0, 0x65, 0x4f, 0x92, 0x07, 0x31,
+    0x7e, 0x31, 0x5f, 0x70, 0x42, 0xe5, 0xd7, 0x32, 0x34, 0x9c, 0xb7, 0x02, 0x7c, 0x65, 0xbe, 0x26,
+    0x98, 0x83, 0x1e, 0x99, 0xcf, 0x95, 0x34, 0x3c, 0xfc, 0x22, 0x58, 0xe6, 0x77, 0xdb, 0x16, 0x99,
+    0x58, 0x6f, 0x83, 0xfc, 0xef, 0x86, 0x81, 0xef, 0x86, 0x82, 0xef, 0x85, 0x83, 0x23, 0x21, 0xe1,
+    0x11, 0x47, 0x5b, 0x33, 0xd4, 0x89, 0x42, 0x4d, 0x1d, 0xc9, 0xf2, 0xe8, 0x3c, 0xac, 0xb9, 0x69,
+    0x15, 0x54, 0xd2, 0xc7, 0xdf, 0x93, 0x91, 0xef, 0x1f, 0x53, 0x69, 0x83, 0x02, 0xd5, 0xb7, 0xf0,
+    0x50, 0x15, 0x7f, 0xf5, 0xea, 0xaa, 0x7c, 0x9e, 0xf4, 0xab, 0xcb, 0x91, 0x49, 0xdf, 0x5c, 0x26,
+    0x4f, 0xfa, 0xe6, 0xcb, 0x82, 0xff, 0x01, 0xe2, 0x29, 0xd7, 0x1e, 0x3d, 0x28, 0x00, 0x00,
+};
 
-    <div class="controls">
-        <div class="switch-row">
-            <span>Auto Mode</span>
-            <label class="switch">
-                <input type="checkbox" id="auto-mode" checked onchange="toggleAuto()">
-                <span class="slider"></span>
-            </label>
-        </div>
-        <button class="button" id="pump-button" onclick="togglePump()">
-            Start Watering
-        </button>
-    </div>
-
-    <div class="toast" id="toast"></div>
-
-    <script>
-        let pumpActive = false;
-        let eventSource;
-
-        function showToast(message) {
-            const toast = document.getElementById('toast');
-            toast.textContent = message;
-            toast.classList.add('show');
-            setTimeout(() => toast.classList.remove('show'), 3000);
-        }
-
-        function updateCard(id, value, unit) {
-            const card = document.getElementById(id + '-card');
-            const valueElem = document.getElementById(id + '-value');
-            
-            if (value === null) {
-                card.classList.add('error');
-                valueElem.textContent = 'Error';
-                return;
-            }
-            
-            card.classList.remove('error');
-            valueElem.textContent = `${value}${unit}`;
-        }
-
-        function toggleAuto() {
-            const isAuto = document.getElementById('auto-mode').checked;
-            fetch('/api/control?auto=' + isAuto)
-                .catch(() => showToast('Failed to change mode'));
-        }
-
-        function togglePump() {
-            pumpActive = !pumpActive;
-            const btn = document.getElementById('pump-button');
-            btn.textContent = pumpActive ? 'Stop Watering' : 'Start Watering';
-            
-            fetch('/api/control?pump=' + pumpActive)
-                .catch(() => {
-                    pumpActive = !pumpActive;
-                    btn.textContent = pumpActive ? 'Stop Watering' : 'Start Watering';
-                    showToast('Failed to control pump');
-                });
-        }
-
-        function initEventSource() {
-            if (eventSource) eventSource.close();
-            
-            eventSource = new EventSource('/events');
-            
-            eventSource.addEventListener('sensors', e => {
-                const data = JSON.parse(e.data);
-                updateCard('moisture', data.soil_moisture, '%');
-                updateCard('temp', data.temperature, '°C');
-                updateCard('humidity', data.humidity, '%');
-                
-                document.getElementById('pump-button').disabled = data.sensor_error;
-            });
-
-            eventSource.addEventListener('pump', e => {
-                pumpActive = e.data === 'pump_on';
-                document.getElementById('pump-button').textContent = 
-                    pumpActive ? 'Stop Watering' : 'Start Watering';
-                showToast(pumpActive ? 'Watering started' : 'Watering stopped');
-            });
-
-            eventSource.addEventListener('auto', e => {
-                const isAuto = e.data === 'auto_on';
-                document.getElementById('auto-mode').checked = isAuto;
-                showToast(isAuto ? 'Auto mode enabled' : 'Auto mode disabled');
-            });
-
-            eventSource.onerror = () => {
-                document.getElementById('status-text').textContent = 'Disconnected';
-                document.getElementById('wifi-status').style.background = 'rgba(244,67,54,0.2)';
-                setTimeout(initEventSource, 5000);
-            };
-        }
-
-        // Start the app
-        document.addEventListener('DOMContentLoaded', () => {
-            initEventSource();
-            
-            // Initial status fetch
-            fetch('/api/status')
-                .then(r => r.json())
-                .then(data => {
-                    updateCard('moisture', data.soil_moisture, '%');
-                    updateCard('temp', data.temperature, '°C');
-                    updateCard('humidity', data.humidity, '%');
-                    document.getElementById('auto-mode').checked = data.auto_mode;
-                    document.getElementById('pump-button').textContent = 
-                        data.pump_active ? 'Stop Watering' : 'Start Watering';
-                })
-                .catch(() => showToast('Failed to get initial status'));
-        });
-    </script>
-</body>
-</html>
-)rawliteral";
-
-#endif 
\ No newline at end of file
+#endif
@@ -0,0 +1,154 @@
+#ifndef ZONE_RESPONSE_H
+#define ZONE_RESPONSE_H
+
+#include <stdint.h>
+#include "config.h"
+
+#define RESPONSE_FRAC_BITS 8        // Fraction bits of the slope and soak pool
+#define RESPONSE_LAG_MAX 1800000UL  // ms; a longer soak-in time is clamped
+#define RESPONSE_MIN_RISE 20        // 0.1 %; smaller waterings teach nothing
+
+// How one zone's moisture answers to watering, learned from its own runs,
+// all integer math.
+//
+// The soil is modelled as first order: pumped water collects in a pool that
+// soaks in towards the probe with time constant lag, so the reading keeps
+// rising after the pump stops. After each run the settled peak gives the
+// slope, moisture per second of pumping. How little of that rise showed up
+// while the pump ran gives the lag. With D the rise during a run of T and
+// R the total rise, a first-order soak gives D/R ~ x / (2 + 2x/3) for
+// x = T/lag, so lag = T(3R - 2D) / 6D.
+//
+// Between readings the pool fills at the learned slope while pumping and
+// drains into the soil over the lag, so reading + pool is the moisture the
+// zone will settle at. Every call is constant time.
+class ZoneResponse {
+public:
+    // Moves the soak model on to now; water enters at the learned slope
+    // while pumping
+    void advance(unsigned long now, bool pumping) {
+        unsigned long dt = now - _last;
+        _last = now;
+        if (pumping) {
+            _pool += (int32_t)(((int64_t)_slope * dt) / 1000);
+        }
+        if (_pool > 0) {
+            // Implicit step, stable for any dt and exact at lag 0
+            _pool -= (int32_t)(((int64_t)_pool * dt) / (_lag + dt > 0 ? _lag + dt : 1));
+        }
+    }
+
+    void started(int16_t moisture, unsigned long now) {
+        advance(now, false);
+        _start = moisture;
+        _startedAt = now;
+        _phase = PHASE_PUMPING;
+    }
+
+    void stopped(int16_t moisture, unsigned long now) {
+        advance(now, true);
+        if (_phase != PHASE_PUMPING) {
+            return;
+        }
+        _stop = moisture;
+        _run = now - _startedAt;
+        _peak = moisture;
+        _peakAt = now;
+        _phase = PHASE_SETTLING;
+    }
+
+    // A completed reading. Once the moisture after a run has stopped rising
+    // for RESPONSE_SETTLE_MS (or the lag, if longer), the run is learned from.
+    void reading(int16_t moisture, unsigned long now) {
+        if (_phase != PHASE_SETTLING) {
+            return;
+        }
+        if (moisture > _peak) {
+            _peak = moisture;
+            _peakAt = now;
+        }
+        unsigned long quiet = _lag > RESPONSE_SETTLE_MS ? _lag : RESPONSE_SETTLE_MS;
+        if (now - _peakAt >= quiet) {
+            learn();
+            _phase = PHASE_IDLE;
+        }
+    }
+
+    // The moisture (0.1 %) a zone now reading moisture will settle at
+    int16_t settled(int16_t moisture) const {
+        return moisture + ((_pool + (1 << (RESPONSE_FRAC_BITS - 1))) >> RESPONSE_FRAC_BITS);
+    }
+
+    // Milliseconds of pumping to settle at target (0.1 %); 0 if it already
+    // will, ~0UL until a run has been learned
+    unsigned long runFor(int16_t moisture, int16_t target) const {
+        if (_slope <= 0) {
+            return ~0UL;
+        }
+        int32_t missing = target - settled(moisture);
+        if (missing <= 0) {
+            return 0;
+        }
+        return (unsigned long)((((int64_t)missing << RESPONSE_FRAC_BITS) * 1000) / _slope);
+    }
+
+    // A run is still settling, or learned water has yet to soak in
+    bool soaking() const {
+        return _phase != PHASE_IDLE || _pool >= (1 << (RESPONSE_FRAC_BITS - 1));
+    }
+
+    bool learned() const { return _slope > 0; }
+    uint32_t runs() const { return _runs; }
+
+    // Slope in 0.01 % per second of pumping, lag in ms
+    int32_t slope() const { return (_slope * 10) >> RESPONSE_FRAC_BITS; }
+    unsigned long lag() const { return _lag; }
+
+private:
+    enum Phase : uint8_t {
+        PHASE_IDLE,
+        PHASE_PUMPING,
+        PHASE_SETTLING
+    };
+
+    // Folds the run just settled into the estimates: the first run sets
+    // them, later ones move them a quarter of the way
+    void learn() {
+        int32_t rise = _peak - _start;
+        int32_t during = _stop - _start;
+        if (rise < RESPONSE_MIN_RISE || _run == 0) {
+            return;
+        }
+        int32_t slope = (int32_t)((((int64_t)rise << RESPONSE_FRAC_BITS) * 1000) / _run);
+        unsigned long lag = RESPONSE_LAG_MAX;
+        if (during > 0 && during < rise) {
+            uint64_t estimate = (uint64_t)_run * (3 * rise - 2 * during) / (6 * during);
+            lag = estimate < RESPONSE_LAG_MAX ? (unsigned long)estimate : RESPONSE_LAG_MAX;
+        } else if (during >= rise) {
+            lag = 0;
+        }
+        if (_runs == 0) {
+            _slope = slope;
+            _lag = lag;
+        } else {
+            _slope += (slope - _slope) / 4;
+            _lag = (unsigned long)((long)_lag + ((long)lag - (long)_lag) / 4);
+        }
+        _runs++;
+    }
+
+    int32_t _slope = 0;          // 0.1 % per s of pumping, RESPONSE_FRAC_BITS fixed point; 0 = unknown
+    unsigned long _lag = 0;      // ms
+    int32_t _pool = 0;           // 0.1 % still soaking in, RESPONSE_FRAC_BITS fixed point
+    unsigned long _last = 0;
+    Phase _phase = PHASE_IDLE;
+    int16_t _start = 0;          // moisture at the pump start
+    int16_t _stop = 0;           // and at the stop
+    int16_t _peak = 0;
+    unsigned long _startedAt = 0;
+    unsigned long _run = 0;      // ms
+    unsigned long _peakAt = 0;
+    uint32_t _runs = 0;          // runs learned from
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Heap soak test for the plant_monitor and SOIL firmware.
+
+Drives a steady mix of synthetic requests against the device from several
+threads and scrapes the heap gauges from /api/metrics at a fixed interval.
+At the end the run is split into quarters and the largest free block and
+fragmentation of each quarter are compared: if the last quarters are no
+worse than the second, fragmentation has plateaued; if they keep getting
+worse, something is still fragmenting the heap.
+
+Build the firmware with HEAP_SOAK 1 to run measurements and broadcasts at
+10x the normal rate, so a few hours cover days of normal traffic.
+
+Requires: Python 3 only (pip install websocket-client for --ws on SOIL)
+Usage:    python3 tools/heap_soak.py --host 192.168.1.50 --hours 4
+          python3 tools/heap_soak.py --host 192.168.4.1 --target soil --ws
+"""
+
+import argparse
+import http.client
+import random
+import re
+import threading
+import time
+
+GAUGE = re.compile(r"^(heap_\w+) (\d+)$", re.M)
+
+# Requests per firmware: (method, path, headers, body)
+REQUESTS = {
+    "plant": [
+        ("GET", "/", {}, None),
+        ("GET", "/", {"If-None-Match": "stale"}, None),
+        ("GET", "/api/status", {}, None),
+        ("GET", "/api/history?tier=0", {}, None),
+        ("GET", "/api/history?tier=1", {}, None),
+        ("GET", "/api/export?format=csv", {}, None),
+        ("GET", "/api/export?format=ndjson", {}, None),
+        ("POST", "/api/control", {"Content-Type": "application/x-www-form-urlencoded"}, "auto=true"),
+        ("GET", "/events", {}, None),
+    ],
+    "soil": [
+        ("GET", "/", {}, None),
+        ("GET", "/generate_204", {}, None),
+        ("GET", "/hotspot-detect.html", {}, None),
+        ("GET", "/connecttest.txt", {}, None),
+        ("GET", "/favicon.ico", {}, None),
+        ("GET", "/some/other/page", {}, None),
+    ],
+}
+
+
+def request_worker(host, requests, stop, counts):
+    while not stop.is_set():
+        method, path, headers, body = random.choice(requests)
+        try:
+            conn = http.client.HTTPConnection(host, timeout=5)
+            conn.request(method, path, body=body, headers=headers)
+            response = conn.getresponse()
+            if path == "/events":
+                # Hold the event stream briefly, then drop it mid-stream
+                response.read1(256)
+                time.sleep(random.uniform(0.5, 3))
+            else:
+                response.read()
+            conn.close()
+            counts["ok"] += 1
+        except (OSError, http.client.HTTPException):
+            counts["failed"] += 1
+            time.sleep(1)
+
+
+def ws_worker(host, stop, counts):
+    import websocket
+    while not stop.is_set():
+        try:
+            ws = websocket.create_connection("ws://%s/ws" % host, timeout=5)
+            if random.random() < 0.5:
+                ws.send('{"command":"binary","state":1}')
+            deadline = time.time() + random.uniform(1, 10)
+            while time.time() < deadline and not stop.is_set():
+                ws.recv()
+            ws.close()
+            counts["ok"] += 1
+        except Exception:
+            counts["failed"] += 1
+            time.sleep(1)
+
+
+def scrape(host):
+    conn = http.client.HTTPConnection(host, timeout=10)
+    conn.request("GET", "/api/metrics")
+    text = conn.getresponse().read().decode()
+    conn.close()
+    return {name: int(value) for name, value in GAUGE.findall(text)}
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--host", required=True)
+    parser.add_argument("--target", choices=sorted(REQUESTS), default="plant")
+    parser.add_argument("--hours", type=float, default=1)
+    parser.add_argument("--threads", type=int, default=3)
+    parser.add_argument("--ws", action="store_true", help="also churn WebSocket clients (SOIL)")
+    parser.add_argument("--interval", type=float, default=30, help="seconds between scrapes")
+    args = parser.parse_args()
+
+    stop = threading.Event()
+    counts = {"ok": 0, "failed": 0}
+    threads = [threading.Thread(target=request_worker,
+                                args=(args.host, REQUESTS[args.target], stop, counts))
+               for _ in range(args.threads)]
+    if args.ws:
+        threads.append(threading.Thread(target=ws_worker, args=(args.host, stop, counts)))
+    for thread in threads:
+        thread.daemon = True
+        thread.start()
+
+    samples = []
+    end = time.time() + args.hours * 3600
+    print("minutes  requests  failed  free   max_block  frag%")
+    start = time.time()
+    try:
+        while time.time() < end:
+            time.sleep(args.interval)
+            try:
+                gauges = scrape(args.host)
+            except (OSError, http.client.HTTPException):
+                print("scrape failed")
+                continue
+            samples.append(gauges)
+            print("%7.1f  %8d  %6d  %5d  %9d  %5d" % (
+                (time.time() - start) / 60, counts["ok"], counts["failed"],
+                gauges.get("heap_free_bytes", 0), gauges.get("heap_max_block_bytes", 0),
+                gauges.get("heap_fragmentation_percent", 0)))
+    except KeyboardInterrupt:
+        pass
+    stop.set()
+
+    if len(samples) < 8:
+        print("Not enough samples for a verdict")
+        return 1
+
+    quarter = len(samples) // 4
+    quarters = [samples[i * quarter:(i + 1) * quarter] for i in range(4)]
+    blocks = [min(s["heap_max_block_bytes"] for s in q) for q in quarters]
+    frags = [max(s["heap_fragmentation_percent"] for s in q) for q in quarters]
+    print("Worst max block per quarter: %s" % blocks)
+    print("Worst fragmentation per quarter: %s" % frags)
+    print("Low-water marks: free %d, max block %d, fragmentation %d%%" % (
+        samples[-1].get("heap_free_min_bytes", 0), samples[-1].get("heap_max_block_min_bytes", 0),
+        samples[-1].get("heap_fragmentation_max_percent", 0)))
+
+    # The first quarter includes warm-up; judge the trend after it
+    growing = blocks[3] < blocks[1] * 0.9 or frags[3] > frags[1] + 5
+    print("Fragmentation is %s" % ("still growing" if growing else "on a plateau"))
+    return 1 if growing else 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
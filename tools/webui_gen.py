@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""Generate webui.h from a sketch's web/index.html.
+
+The page is gzipped (deterministically, so unchanged sources give an
+unchanged header) and emitted as a PROGMEM byte array together with its
+length and a strong ETag derived from the content hash. The firmware serves
+the array as-is with Content-Encoding: gzip.
+
+Usage: python3 tools/webui_gen.py plant_monitor SOIL
+Run it after editing any <sketch>/web/index.html and commit both files.
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+HEADER = """// Generated by tools/webui_gen.py from web/index.html - do not edit
+#ifndef WEBUI_H
+#define WEBUI_H
+
+#define INDEX_HTML_GZ_LEN {length}
+#define INDEX_HTML_ETAG "\\"{etag}\\""
+
+const uint8_t INDEX_HTML_GZ[] PROGMEM = {{
+{data}
+}};
+
+#endif
+"""
+
+
+def generate(sketch_dir):
+    source = os.path.join(sketch_dir, "web", "index.html")
+    with open(source, "rb") as f:
+        html = f.read()
+
+    compressed = gzip.compress(html, compresslevel=9, mtime=0)
+    etag = hashlib.sha1(html).hexdigest()[:16]
+
+    lines = []
+    for i in range(0, len(compressed), 16):
+        chunk = compressed[i:i + 16]
+        lines.append("    " + ", ".join("0x%02x" % b for b in chunk) + ",")
+
+    output = os.path.join(sketch_dir, "webui.h")
+    with open(output, "w") as f:
+        f.write(HEADER.format(length=len(compressed), etag=etag,
+                              data="\n".join(lines)))
+
+    print("%s: %d -> %d bytes, ETag %s" % (output, len(html), len(compressed), etag))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__.strip())
+        return 1
+    for sketch_dir in sys.argv[1:]:
+        generate(sketch_dir)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""WebSocket fan-out stress test for the SOIL firmware.
+
+Opens 1..N WebSocket clients against /ws, holds each level for a while and
+scrapes heap_free_bytes and ws_clients from /api/metrics once a second. The
+heap gauge is sampled by the firmware every HEAP_SAMPLE_INTERVAL, so the
+sample rate does not depend on how often the deadband lets a broadcast out.
+With the shared broadcast buffer the free heap should stay flat as clients
+are added (apart from the fixed per-connection TCP cost).
+
+Requires: pip install websocket-client
+Usage:    python3 tools/ws_stress.py [--host 192.168.4.1]
+"""
+
+import argparse
+import http.client
+import re
+import threading
+import time
+
+import websocket
+
+GAUGE = re.compile(r"^(heap_free_bytes|ws_clients) (\d+)$", re.M)
+
+
+def client_worker(url, stop, counts, index):
+    ws = websocket.create_connection(url, timeout=10)
+    ws.settimeout(1)
+    while not stop.is_set():
+        try:
+            ws.recv()
+            counts[index] += 1
+        except websocket.WebSocketTimeoutException:
+            pass
+    ws.close()
+
+
+def scrape(host):
+    conn = http.client.HTTPConnection(host, timeout=10)
+    conn.request("GET", "/api/metrics")
+    text = conn.getresponse().read().decode()
+    conn.close()
+    return {name: int(value) for name, value in GAUGE.findall(text)}
+
+
+def read_heap(host, seconds, interval):
+    samples = []
+    deadline = time.time() + seconds
+    while time.time() < deadline:
+        started = time.time()
+        try:
+            gauges = scrape(host)
+            if "heap_free_bytes" in gauges and "ws_clients" in gauges:
+                samples.append((gauges["heap_free_bytes"], gauges["ws_clients"]))
+        except OSError:
+            pass
+        time.sleep(max(0, interval - (time.time() - started)))
+    return samples
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--host", default="192.168.4.1")
+    parser.add_argument("--max-clients", type=int, default=8)
+    parser.add_argument("--hold", type=float, default=20, help="seconds per level")
+    parser.add_argument("--interval", type=float, default=1, help="seconds between scrapes")
+    args = parser.parse_args()
+
+    url = "ws://%s/ws" % args.host
+    stop = threading.Event()
+    counts = [0] * args.max_clients
+    threads = []
+
+    print("clients  samples  min_free  max_free  frames/client")
+    for level in range(1, args.max_clients + 1):
+        thread = threading.Thread(target=client_worker,
+                                  args=(url, stop, counts, level - 1))
+        thread.start()
+        threads.append(thread)
+        time.sleep(2)  # let the connect burst settle
+
+        start = list(counts)
+        samples = [free for free, clients in read_heap(args.host, args.hold, args.interval)
+                   if clients == level]
+        frames = sum(c - s for c, s in zip(counts, start)) / level
+        if samples:
+            print("%7d  %7d  %8d  %8d  %13.1f" % (level, len(samples), min(samples),
+                                                 max(samples), frames))
+        else:
+            print("%7d  no heap samples" % level)
+
+    stop.set()
+    for thread in threads:
+        thread.join()
+
+
+if __name__ == "__main__":
+    main()